@@ -0,0 +1,256 @@
+/**
+ * @file analysis.cpp
+ * @brief Per-cache access distributions for the cache simulator
+ *
+ * The reuse distance of an access is the number of distinct other blocks the
+ * cache saw since the last access to the same block; the first access to a
+ * block is cold. A fully associative LRU cache of C blocks hits exactly the
+ * accesses with a distance below C. A map of block numbers keeps each block's
+ * last access time and counts its misses for the top missing blocks list. A
+ * Fenwick tree over the access times marks the last access of every block, so
+ * the distance is the count of marks since the block's own, found in
+ * O(log n). Once the tree runs out of times, the marks are renumbered in
+ * order so the tree only grows with the number of distinct blocks.
+ *
+ * CSV output has one row per record:
+ *     cache,record,key,accesses,misses,evictions
+ * with record "reuse" (key = bucket, accesses = count), "cold" (accesses =
+ * count), "set" (key = set index) and "top" (key = block address in hex,
+ * misses = count). Binary output starts with the magic "CSAN" and a uint32
+ * version, then per cache: char name[64], uint64 sets, uint64 cold,
+ * uint64 reuse[REUSE_BUCKETS], uint64 {accesses, misses, evictions}[sets],
+ * uint64 n, uint64 {address, misses}[n], all little endian.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "analysis.hpp"
+#include "u64_map.hpp"
+
+static const uint64_t BLOCKS_INITIAL_ENTRIES = 1024;
+static const uint64_t TIMES_INITIAL_ENTRIES = 1 << 12;
+static const uint32_t BINARY_VERSION = 1;
+
+typedef struct block_entry {
+    uint64_t last;      // time of the last access
+    uint64_t misses;
+} block_entry;
+
+// A block that missed, for the top missing blocks list
+typedef struct block_misses {
+    uint64_t blk;
+    uint64_t misses;
+} block_misses;
+
+typedef struct set_counts {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t evictions;
+} set_counts;
+
+struct analysis {
+    uint64_t block_bits;
+    uint64_t* tree;     // Fenwick tree over times, 1 at the last access of every block
+    uint64_t times;     // times the tree covers
+    uint64_t now;       // time of the next access
+    uint64_t cold;
+    uint64_t reuse[REUSE_BUCKETS];
+    set_counts* sets;
+    uint64_t num_sets;
+    struct u64_map* blocks; // block_entry by block number
+};
+
+// Mark or unmark time i of the Fenwick tree
+static void tree_add(struct analysis *an, uint64_t i, uint64_t delta) {
+    for (i++; i <= an->times; i += i & (~i + 1)) {
+        an->tree[i] += delta;
+    }
+}
+
+// Count the marks of the times before i
+static uint64_t tree_count(const struct analysis *an, uint64_t i) {
+    uint64_t sum = 0;
+    for (; i > 0; i -= i & (~i + 1)) {
+        sum += an->tree[i];
+    }
+    return sum;
+}
+
+static bool last_before(const block_entry *a, const block_entry *b) {
+    return a->last < b->last;
+}
+
+/**
+ * Function to give the blocks the times 0 to n - 1 in the order of their last
+ * accesses and rebuild the tree, at least four times as big as the blocks so
+ * compacting stays a small share of the accesses
+ *
+ */
+static void times_compact(struct analysis *an) {
+    uint64_t n = u64_map_size(an->blocks);
+    block_entry **order = (block_entry**) malloc((n ? n : 1) * sizeof(block_entry*));
+    uint64_t pos = 0;
+    uint64_t blk;
+    for (uint64_t i = 0; i < n; i++) {
+        order[i] = (block_entry*) u64_map_next(an->blocks, &pos, &blk);
+    }
+    std::sort(order, order + n, last_before);
+    for (uint64_t i = 0; i < n; i++) {
+        order[i]->last = i;
+    }
+    free(order);
+    an->times = 4 * n > an->times ? 4 * n : an->times;
+    free(an->tree);
+    an->tree = (uint64_t*) calloc(an->times + 1, sizeof(uint64_t));
+    //every time below n is marked, each node adds itself to its parent
+    for (uint64_t i = 1; i <= an->times; i++) {
+        an->tree[i] += i <= n;
+        uint64_t parent = i + (i & (~i + 1));
+        if (parent <= an->times) {
+            an->tree[parent] += an->tree[i];
+        }
+    }
+    an->now = n;
+}
+
+struct analysis* analysis_create(uint64_t sets, uint64_t block_bits)
+{
+    struct analysis *an = (struct analysis*) calloc(1, sizeof(struct analysis));
+    an->block_bits = block_bits;
+    an->num_sets = sets;
+    an->sets = (set_counts*) calloc(sets, sizeof(set_counts));
+    an->blocks = u64_map_create(BLOCKS_INITIAL_ENTRIES, sizeof(block_entry));
+    an->times = TIMES_INITIAL_ENTRIES;
+    an->tree = (uint64_t*) calloc(an->times + 1, sizeof(uint64_t));
+    return an;
+}
+
+/**
+ * Function to record one demand access of the cache
+ *
+ * @param an The analysis of the cache
+ * @param blk Block number of the access
+ * @param set Set the access looked up
+ * @param miss True if the cache counted a miss
+ */
+void analysis_access(struct analysis *an, uint64_t blk, uint64_t set, bool miss)
+{
+    if (an->now == an->times) {
+        times_compact(an);
+    }
+    bool added;
+    block_entry *e = (block_entry*) u64_map_add(an->blocks, blk, &added);
+    if (added) {
+        an->cold++;
+    } else {
+        //blocks whose last access came after this block's
+        uint64_t distance = tree_count(an, an->now) - tree_count(an, e->last + 1);
+        an->reuse[distance ? 64 - __builtin_clzll(distance) : 0]++;
+        tree_add(an, e->last, (uint64_t)-1);
+    }
+    e->last = an->now++;
+    tree_add(an, e->last, 1);
+    an->sets[set].accesses++;
+    if (miss) {
+        e->misses++;
+        an->sets[set].misses++;
+    }
+}
+
+void analysis_evict(struct analysis *an, uint64_t set)
+{
+    an->sets[set].evictions++;
+}
+
+void analysis_header(FILE *out, enum output_format format)
+{
+    if (format == OUTPUT_BINARY) {
+        fwrite("CSAN", 1, 4, out);
+        fwrite(&BINARY_VERSION, sizeof(BINARY_VERSION), 1, out);
+    } else {
+        fprintf(out, "cache,record,key,accesses,misses,evictions\n");
+    }
+}
+
+/**
+ * Function to write the distributions of one cache
+ *
+ * @param out Output file, after analysis_header
+ * @param format CSV or binary records
+ * @param name Printed name of the cache
+ * @param an The analysis of the cache
+ * @param top Most blocks listed in the top missing blocks
+ */
+void analysis_write(FILE *out, enum output_format format, const char *name, const struct analysis *an, uint64_t top)
+{
+    //pick the blocks that missed most, ties to the lower block number
+    block_misses *best = (block_misses*) calloc(top ? top : 1, sizeof(block_misses));
+    uint64_t n = 0;
+    uint64_t pos = 0;
+    uint64_t blk;
+    const block_entry *e;
+    while ((e = (const block_entry*) u64_map_next(an->blocks, &pos, &blk)) != NULL) {
+        if (e->misses == 0) {
+            continue;
+        }
+        uint64_t j = n < top ? n++ : top;
+        while (j > 0 && (best[j - 1].misses < e->misses || (best[j - 1].misses == e->misses && best[j - 1].blk > blk))) {
+            if (j < top) {
+                best[j] = best[j - 1];
+            }
+            j--;
+        }
+        if (j < top) {
+            best[j].blk = blk;
+            best[j].misses = e->misses;
+        }
+    }
+
+    if (format == OUTPUT_BINARY) {
+        char label[64];
+        memset(label, 0, sizeof(label));
+        strncpy(label, name, sizeof(label) - 1);
+        fwrite(label, 1, sizeof(label), out);
+        fwrite(&an->num_sets, sizeof(uint64_t), 1, out);
+        fwrite(&an->cold, sizeof(uint64_t), 1, out);
+        fwrite(an->reuse, sizeof(uint64_t), REUSE_BUCKETS, out);
+        fwrite(an->sets, sizeof(set_counts), an->num_sets, out);
+        fwrite(&n, sizeof(uint64_t), 1, out);
+        for (uint64_t i = 0; i < n; i++) {
+            uint64_t pair[2] = {best[i].blk << an->block_bits, best[i].misses};
+            fwrite(pair, sizeof(uint64_t), 2, out);
+        }
+    } else {
+        fprintf(out, "%s,cold,0,%" PRIu64 ",0,0\n", name, an->cold);
+        for (uint64_t b = 0; b < REUSE_BUCKETS; b++) {
+            if (an->reuse[b]) {
+                fprintf(out, "%s,reuse,%" PRIu64 ",%" PRIu64 ",0,0\n", name, b, an->reuse[b]);
+            }
+        }
+        for (uint64_t s = 0; s < an->num_sets; s++) {
+            fprintf(out, "%s,set,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", name, s,
+                    an->sets[s].accesses, an->sets[s].misses, an->sets[s].evictions);
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            fprintf(out, "%s,top,0x%" PRIx64 ",0,%" PRIu64 ",0\n", name, best[i].blk << an->block_bits, best[i].misses);
+        }
+    }
+    free(best);
+}
+
+void analysis_destroy(struct analysis *an)
+{
+    if (an == NULL) {
+        return;
+    }
+    free(an->sets);
+    u64_map_destroy(an->blocks);
+    free(an->tree);
+    free(an);
+}
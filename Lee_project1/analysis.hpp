@@ -0,0 +1,33 @@
+/**
+ * @file analysis.hpp
+ * @brief Per-cache access distributions for the cache simulator
+ *
+ * An analysis follows the demand accesses and evictions of one cache and
+ * gathers a log2 histogram of reuse distances in distinct blocks, per-set
+ * access, miss and eviction counts and the blocks that missed most. A cache without one pays a single
+ * pointer check per access.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "cache.hpp"
+
+// Reuse distance buckets: 0, 1, then [2^(b-1), 2^b) for bucket b
+static const uint64_t REUSE_BUCKETS = 65;
+
+struct analysis;
+
+struct analysis* analysis_create(uint64_t sets, uint64_t block_bits);
+void analysis_access(struct analysis *an, uint64_t blk, uint64_t set, bool miss);
+void analysis_evict(struct analysis *an, uint64_t set);
+void analysis_header(FILE *out, enum output_format format);
+void analysis_write(FILE *out, enum output_format format, const char *name, const struct analysis *an, uint64_t top);
+void analysis_destroy(struct analysis *an);
+
+#endif // ANALYSIS_H
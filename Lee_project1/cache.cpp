@@ -16,6 +16,14 @@
 #include <cmath>
 
 #include "cache.hpp"
+#include "analysis.hpp"
+#include "classify.hpp"
+#include "coherence.hpp"
+#include "dram.hpp"
+#include "events.hpp"
+#include "tlb.hpp"
+#include "prefetch.hpp"
+#include "timeseries.hpp"
 
 // Use this for printing errors while debugging your code
 // Most compilers support the __LINE__ argument with a %d argument type
@@ -31,37 +39,59 @@ static inline void print_error_exit(const char *msg, ...)
 
 // Define data structures and globals you might need for simulating the cache hierarchy below
 
-// TODO
-uint64_t blockNum_l1_data;
-uint64_t blockNum_l1_inst;
-uint64_t blockNum_l2;
-uint64_t offsetBit;
-uint64_t tagBit_l1_data;
-uint64_t tagBit_l1_inst;
-uint64_t tagBit_l2;
-uint64_t indexBit_l1_data;
-uint64_t indexBit_l1_inst;
-uint64_t indexBit_l2;
-uint64_t indexNum_l1_data;
-uint64_t indexNum_l1_inst;
-uint64_t indexNum_l2;
-uint64_t wayNum_l1_data;
-uint64_t wayNum_l1_inst;
-uint64_t wayNum_l2;
 uint64_t MAX = 0;
 uint64_t tmp;
 
+// One BIP fill in BIP_INTERVAL goes to the MRU position
+static const uint64_t BIP_INTERVAL = 32;
+// Dead block predictor: 2-bit counters shared by the blocks of a 4KiB region, and
+// one set in DBP_SAMPLE that always fills so the predictions keep being checked
+static const uint64_t DBP_ENTRIES_BITS = 12;
+static const uint64_t DBP_REGION_BITS = 12;
+static const uint64_t DBP_SAMPLE = 32;
+// Entries of the address hashed way prediction table
+static const uint64_t WAY_TABLE_BITS = 10;
+// Way of an event that has none
+static const uint64_t NO_WAY = ~(uint64_t)0;
+// Checkpoint format, and the values a cache's checkpoint depends on
+static const uint32_t CHECKPOINT_VERSION = 1;
+static const uint64_t CHECKPOINT_SHAPE = 17;
+
 uint64_t count = 1;
+uint64_t cycle = 0;
+char fill_type = LOAD;  // access class and core new blocks are filled for
+uint64_t fill_core = 0;
+uint64_t issue_interval;
+uint64_t core_cycle[MAX_CORES];
 
+enum memory_model mem_model;
+bool classify_misses;
+bool latency_histogram;
+struct analysis_config_t analysis_conf;
+struct event_log* event_log; // event log only
+uint64_t access_seq = 0;     // core accesses done, the sequence number of logged events
 
-enum write_policy wp;
-enum replacement_policy rp;
+// Build with -DCACHESIM_NO_EVENTS to leave the event log out altogether
+#ifdef CACHESIM_NO_EVENTS
+#define LOG_EVENT(kind, c, set, way, tag) ((void)0)
+#else
+#define LOG_EVENT(kind, c, set, way, tag) \
+    do { if (event_log != NULL) event_record(event_log, kind, access_seq, (c)->id, (c)->level, set, way, tag); } while (0)
+#endif
 
 typedef struct block {
     bool valid;
     bool dirty;
+    bool prefetched; // brought in by a prefetch and not used yet
+    uint8_t cls;     // access class and core the block was filled for, for way partitioning
+    uint8_t owner;
+    bool reused;     // hit since its fill
+    bool predicted_dead; // dead block prediction at fill time
+    uint64_t sectors;       // valid sectors, bit 0 is the lowest addressed
+    uint64_t dirty_bytes;   // written bytes, a bit per byte or per 1/64 of a bigger block
     uint64_t tag;
     uint64_t history;
+    uint64_t ready;  // cycle a prefetched block arrives
 } block;
 
 typedef struct info {
@@ -72,622 +102,1844 @@ typedef struct info {
     uint64_t set;
     uint64_t addr;
     uint64_t history;
+    uint64_t sectors;       // sectors and dirty bytes of the block, in the geometry of the cache it left
+    uint64_t dirty_bytes;
+    uint64_t sectorBit;
+    uint64_t chunkBit;
 } info;
 
-block** l1_data_cache;
-block** l1_inst_cache;
-block** l2_cache;
+typedef struct cache_bank {
+    uint64_t ready;     // cycle the bank can start the next access
+    uint64_t* queue;    // completion cycles of the accesses in flight (ring)
+    uint64_t head;      // oldest access in the ring
+} cache_bank;
+
+typedef struct victim_cache {
+    uint64_t entries;
+    block* blocks;      // fully associative, tag holds the whole block number
+} victim_cache;
+
+typedef struct wb_entry {
+    uint64_t addr;      // block number
+    uint64_t bytes;     // dirty byte mask in the geometry of the cache above
+    uint64_t cycle;     // cycle the entry was allocated
+} wb_entry;
+
+typedef struct write_buffer {
+    uint64_t entries;
+    uint64_t used;
+    uint64_t ready;     // cycle the next level can take the next entry
+    wb_entry* slots;    // oldest first
+} write_buffer;
+
+typedef struct cache {
+    uint64_t id;        // index of the cache's statistics in sim_stats->caches
+    uint64_t level;     // 0 is closest to the core
+    uint64_t core;      // core owning a private cache, 0 for a shared one
+    bool coherent;      // private cache of a multi-core run, tracked by the directory
+    int side;           // 0 for an instruction cache, 1 for a data or unified cache
+    const struct cache_config_t *conf;
+    block** sets;
+    uint64_t offsetBit;
+    uint64_t sectorBit; // equal to offsetBit without sectors
+    uint64_t sectorNum;
+    uint64_t chunkBit;  // bytes per bit of a dirty byte mask
+    uint64_t indexBit;
+    uint64_t tagBit;
+    uint64_t indexNum;
+    uint64_t wayNum;
+    enum write_policy wp;
+    enum replacement_policy rp;
+    enum inclusion_policy inclusion;
+    enum index_policy indexing;
+    bool partitioned;   // fills only replace the ways of their class and core
+    uint64_t class_ways[3];
+    uint64_t core_ways[MAX_CORES];
+    enum insertion_policy insertion;
+    uint64_t bip_count;
+    uint8_t* dbp;       // dead block predictor counters, bypassing caches only
+    uint32_t* way_pred; // predicted way by set or by address hash, way predicted caches only
+    cache_bank* banks;  // banked caches only
+    struct classifier* classifier; // miss classification only
+    struct analysis* an; // analysis output only
+    uint64_t bankShift;
+    double fast_hit;    // hit time of a correct way prediction
+    double probe_time;  // hit time of the last lookup in a way predicted cache
+    block* shadow;      // bit-slice indexed copy of the tags, hashed indexing only
+    uint64_t shadow_count;
+    victim_cache vc;
+    write_buffer wbuf;  // between the cache and the next level
+    struct prefetcher* pf;
+} cache;
+
+cache caches[MAX_CACHES];
+uint64_t num_caches;
+uint64_t num_levels;
+uint64_t num_cores;
+uint64_t num_private;   // levels with one copy per core, always the first ones
+//caches by core, level and side, both sides of a unified level point to the same
+//cache and all cores point to the same shared caches
+cache* hierarchy[MAX_CORES][MAX_LEVELS][2];
+
+struct directory* dir;  // MESI directory, multi-core runs only
+uint64_t dirShift;      // address to directory block number
+
+struct vm_config_t vm;
+struct page_table* pt;  // virtual memory only
+struct timeseries* series; // time series only
+struct tlb* tlbs[MAX_CORES][3]; // ITLB, DTLB and L2 TLB of every core
 
-uint64_t restore_addr_l1_inst(uint64_t, uint64_t);
-uint64_t restore_addr_l1_data(uint64_t, uint64_t);
-uint64_t restore_addr_l2(uint64_t, uint64_t);
+void cache_insert(cache*, info, uint64_t, bool*, struct sim_stats_t*);
+double hierarchy_access(uint64_t, uint64_t, uint64_t, char, uint64_t, struct sim_stats_t*);
+void coherence_untrack(uint64_t, uint64_t);
 
 
 /**
- *Helper functions to extract tag and index from physical address
+ *Helper functions for hashed indexing, the index bits of the address are
+ *XORed with a hash of the tag so the tag and index still give back the address
  *
  */
-uint64_t find_index_l1_data(uint64_t addr) {
-    uint64_t tmp = 1;
-    tmp = tmp << indexBit_l1_data;
-    tmp -= 1;
-    addr = addr >> offsetBit;
-    return addr & tmp;
-}
-uint64_t find_tag_l1_data(uint64_t addr) {
-    return addr >> (indexBit_l1_data + offsetBit);
+uint64_t xor_fold(uint64_t tag, uint64_t bits) {
+    uint64_t folded = 0;
+    for (; tag; tag >>= bits) {
+        folded ^= tag & (((uint64_t)1 << bits) - 1);
+    }
+    return folded;
 }
-uint64_t find_index_l1_inst(uint64_t addr) {
-    uint64_t tmp = 1;
-    tmp = tmp << indexBit_l1_inst;
-    tmp -= 1;
-    addr = addr >> offsetBit;
-    return addr & tmp;
+uint64_t skew_hash(cache *c, uint64_t tag, uint64_t way) {
+    //a different odd multiplier per way, the top bits of the product mix every tag bit
+    return (tag * (0x9e3779b97f4a7c15ULL + 2 * way)) >> (64 - c->indexBit);
 }
-uint64_t find_tag_l1_inst(uint64_t addr) {
-    return addr >> (indexBit_l1_inst + offsetBit);
+uint64_t index_hash(cache *c, uint64_t tag, uint64_t way) {
+    switch (c->indexing) {
+        case XOR_INDEX:
+            return xor_fold(tag, c->indexBit);
+        case SKEWED:
+            return skew_hash(c, tag, way);
+        default:
+            return 0;
+    }
 }
-uint64_t find_index_l2(uint64_t addr) {
+
+/**
+ *Helper functions to extract tag and index from physical address
+ *A skewed cache indexes every way differently, find_index only gives the bit-slice
+ *index and way_index the set of one way
+ *
+ */
+uint64_t find_index(cache *c, uint64_t addr) {
     uint64_t tmp = 1;
-    tmp = tmp << indexBit_l2;
+    tmp = tmp << c->indexBit;
     tmp -= 1;
-    addr = addr >> offsetBit;
-    return addr & tmp;
+    uint64_t slice = (addr >> c->offsetBit) & tmp;
+    return c->indexing == XOR_INDEX ? slice ^ xor_fold(addr >> (c->indexBit + c->offsetBit), c->indexBit) : slice;
+}
+uint64_t find_tag(cache *c, uint64_t addr) {
+    return addr >> (c->indexBit + c->offsetBit);
 }
-uint64_t find_tag_l2(uint64_t addr) {
-    return addr >> (indexBit_l2 + offsetBit);
+uint64_t way_index(cache *c, uint64_t index, uint64_t tag, uint64_t way) {
+    return c->indexing == SKEWED ? index ^ skew_hash(c, tag, way) : index;
 }
 
 /**
- *Helper functions to restore physical address from tag and index
+ *Helper function to restore physical address from tag and the index of a way
  *
  */
-uint64_t restore_addr_l1_inst(uint64_t tag, uint64_t index) {
-    uint64_t addr = tag << (offsetBit + indexBit_l1_inst);
-    addr += index << offsetBit;
+uint64_t restore_addr(cache *c, uint64_t tag, uint64_t index, uint64_t way) {
+    uint64_t addr = tag << (c->offsetBit + c->indexBit);
+    addr += (index ^ index_hash(c, tag, way)) << c->offsetBit;
     return addr;
 }
-uint64_t restore_addr_l1_data(uint64_t tag, uint64_t index) {
-    uint64_t addr = tag << (offsetBit + indexBit_l1_data);
-    addr += index << offsetBit;
-    return addr;
+
+/**
+ *Helper functions for sectored blocks, a block without sectors is a single sector
+ *
+ */
+uint64_t sector_mask(cache *c, uint64_t addr) {
+    return (uint64_t)1 << ((addr >> c->sectorBit) & (c->sectorNum - 1));
 }
-uint64_t restore_addr_l2(uint64_t tag, uint64_t index) {
-    uint64_t addr = tag << (offsetBit + indexBit_l2);
-    addr += index << offsetBit;
-    return addr;
+uint64_t all_sectors(cache *c) {
+    return c->sectorNum == 64 ? ~(uint64_t)0 : ((uint64_t)1 << c->sectorNum) - 1;
+}
+uint64_t sector_bytes(uint64_t sectors, uint64_t sectorBit) {
+    return (uint64_t)__builtin_popcountll(sectors) << sectorBit;
 }
 
-//helper functions to set replacement policy
-void l1inst_set_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
-        case LRU:
-        case FIFO:
-            count++;
-            l1_inst_cache[index][set].history = count;
-            break;
-        case LFU:
-            l1_inst_cache[index][set].history = 1;
-            break;
+/**
+ *Helper functions for dirty byte masks, one bit per byte of a block up to 64
+ *bytes and one per 1/64 of a bigger block
+ *
+ */
+uint64_t bit_range(uint64_t first, uint64_t last) {
+    uint64_t upper = last == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (last + 1)) - 1;
+    return upper & ~(((uint64_t)1 << first) - 1);
+}
+uint64_t sector_chunks(cache *c, uint64_t sectors) {
+    uint64_t per = (uint64_t)1 << (c->sectorBit - c->chunkBit);
+    uint64_t mask = 0;
+    for (; sectors; sectors &= sectors - 1) {
+        uint64_t i = __builtin_ctzll(sectors);
+        mask |= bit_range(i * per, i * per + per - 1);
     }
+    return mask;
 }
-void l1data_set_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
-        case LRU:
-        case FIFO:
-            count++;
-            l1_data_cache[index][set].history = count;
-            break;
-        case LFU:
-            l1_data_cache[index][set].history = 1;
-            break;
+//the bytes of an access inside the block of addr, a size of 0 is the whole sector
+uint64_t byte_mask(cache *c, uint64_t addr, uint64_t size) {
+    if (size == 0) {
+        return sector_chunks(c, sector_mask(c, addr));
+    }
+    uint64_t base = (addr >> c->offsetBit) << c->offsetBit;
+    uint64_t end = addr + size < base + ((uint64_t)1 << c->offsetBit) ? addr + size : base + ((uint64_t)1 << c->offsetBit);
+    return bit_range((addr - base) >> c->chunkBit, (end - 1 - base) >> c->chunkBit);
+}
+//a dirty byte mask of a block at base, moved into the geometry of c at addr
+uint64_t remap_bytes(uint64_t mask, uint64_t base, uint64_t chunkBit, cache *c, uint64_t addr) {
+    uint64_t db = (addr >> c->offsetBit) << c->offsetBit;
+    uint64_t de = db + ((uint64_t)1 << c->offsetBit);
+    if (chunkBit == c->chunkBit && base == db) {
+        return mask;
+    }
+    uint64_t out = 0;
+    for (; mask; mask &= mask - 1) {
+        uint64_t start = base + ((uint64_t)__builtin_ctzll(mask) << chunkBit);
+        uint64_t end = start + ((uint64_t)1 << chunkBit);
+        start = start > db ? start : db;
+        end = end < de ? end : de;
+        if (start < end) {
+            out |= byte_mask(c, start, end - start);
+        }
     }
+    return out;
 }
-void l2_set_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
+
+//helper function to set replacement policy
+void set_rp (cache *c, uint64_t index, uint64_t set) {
+    switch(c->rp) {
         case LRU:
         case FIFO:
             count++;
-            l2_cache[index][set].history = count;
+            c->sets[index][set].history = count;
             break;
         case LFU:
-            l2_cache[index][set].history = 1;
+            c->sets[index][set].history = 1;
             break;
     }
 }
 
-//helper functions to update replacement policy
-void l1inst_update_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
+//helper function to update replacement policy
+void update_rp (cache *c, uint64_t index, uint64_t set) {
+    switch(c->rp) {
         case LRU:
             count++;
-            l1_inst_cache[index][set].history = count;
+            c->sets[index][set].history = count;
             break;
         case LFU:
-            l1_inst_cache[index][set].history++;
+            c->sets[index][set].history++;
             break;
         case FIFO:
             break;
     }
 }
-void l1data_update_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
-        case LRU:
-            count++;
-            l1_data_cache[index][set].history = count;
-            break;
-        case LFU:
-            l1_data_cache[index][set].history++;
-            break;
-        case FIFO:
-            break;
+
+/**
+ * Function to apply the insertion policy to a block set_rp just placed. MRU keeps
+ * it there, LIP moves it behind every other block of its set and BIP does so for
+ * all but one fill in BIP_INTERVAL
+ *
+ */
+void insert_rp(cache *c, uint64_t index, uint64_t tag, uint64_t way) {
+    block *b = &c->sets[way_index(c, index, tag, way)][way];
+    if (c->insertion == INSERT_MRU || (c->insertion == INSERT_BIP && ++c->bip_count % BIP_INTERVAL == 0)) {
+        return;
+    }
+    if (c->rp == LFU) {
+        b->history = 0;
+        return;
+    }
+    uint64_t oldest = MAX;
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        block *other = &c->sets[way_index(c, index, tag, i)][i];
+        if (i != way && other->valid && other->history < oldest) {
+            oldest = other->history;
+        }
     }
+    if (oldest != MAX) {
+        b->history = oldest ? oldest - 1 : 0;
+    }
+}
+
+/**
+ * Helper functions for the way predictor: MRU predicts the way last hit or
+ * filled in the set, the table the one last used by a block with the same hash
+ *
+ */
+uint64_t way_slot(cache *c, uint64_t addr) {
+    if (c->conf->way_pred == WAY_PREDICT_MRU) {
+        return find_index(c, addr);
+    }
+    return ((addr >> c->offsetBit) * 0x9e3779b97f4a7c15ULL) >> (64 - WAY_TABLE_BITS);
+}
+void way_train(cache *c, uint64_t addr, uint64_t way) {
+    if (c->way_pred != NULL) {
+        c->way_pred[way_slot(c, addr)] = way;
+    }
+}
+
+/**
+ * Function to hold the bank of addr in a banked cache for one access arriving at
+ * cycle arrive. The access waits for the bank, and a full bank queue stalls the
+ * core until its oldest access is done, the same way a DRAM channel queue does
+ * Returns the cycles the access waited
+ *
+ */
+uint64_t bank_access(cache *c, uint64_t addr, uint64_t arrive, struct sim_stats_t *sim_stats) {
+    struct cache_stats_t *stats = &sim_stats->caches[c->id];
+    uint64_t n = (addr >> c->bankShift) & (c->conf->banks - 1);
+    cache_bank *b = &c->banks[n];
+    uint64_t now = arrive;
+    if (b->queue[b->head] > now) {
+        stats->num_bank_queue_stalls++;
+        cycle += b->queue[b->head] - now;
+        now = b->queue[b->head];
+    }
+    uint64_t start = b->ready > now ? b->ready : now;
+    b->ready = start + c->conf->bank_busy;
+    b->queue[b->head] = b->ready;
+    b->head = (b->head + 1) % c->conf->bank_queue;
+    stats->bank_accesses[n]++;
+    stats->bank_busy_cycles[n] += c->conf->bank_busy;
+    if (start > arrive) {
+        stats->num_bank_conflicts++;
+        stats->num_bank_conflict_cycles += start - arrive;
+    }
+    return start - arrive;
 }
-void l2_update_rp (uint64_t index, uint64_t set) {
-    switch(rp) {
+
+/**
+ * Helper functions for the dead block predictor of a bypassing cache, a block
+ * evicted without a hit makes its region more likely to be predicted dead
+ *
+ */
+uint64_t dbp_slot(uint64_t addr) {
+    return ((addr >> DBP_REGION_BITS) * 0x9e3779b97f4a7c15ULL) >> (64 - DBP_ENTRIES_BITS);
+}
+bool dbp_dead(cache *c, uint64_t addr) {
+    return c->dbp[dbp_slot(addr)] >= 2;
+}
+bool dbp_sampled(cache *c, uint64_t addr) {
+    return find_index(c, addr) % DBP_SAMPLE == 0;
+}
+void dbp_train(cache *c, block *b, uint64_t addr, struct cache_stats_t *stats) {
+    uint8_t *counter = &c->dbp[dbp_slot(addr)];
+    stats->num_predictions_checked++;
+    if (b->predicted_dead == !b->reused) {
+        stats->num_predictions_correct++;
+    }
+    if (b->reused) {
+        *counter -= *counter > 0;
+    } else {
+        stats->num_dead_evictions++;
+        *counter += *counter < 3;
+    }
+}
+
+/**
+ * Helper functions for the bit-slice shadow of a hashed cache. It keeps only the
+ * tags, allocates on the same demand misses, takes the same fills and uses the
+ * same replacement policy, so its misses are the ones the cache would have
+ * without hashing
+ *
+ */
+void shadow_touch(cache *c, block *b, bool fill) {
+    switch (c->rp) {
         case LRU:
-            count++;
-            l2_cache[index][set].history = count;
+            b->history = ++c->shadow_count;
             break;
         case LFU:
-            l2_cache[index][set].history++;
+            b->history = fill ? 1 : b->history + 1;
             break;
         case FIFO:
+            if (fill) {
+                b->history = ++c->shadow_count;
+            }
             break;
     }
 }
+//a fill of a block the shadow has only adds the sector
+void shadow_fill(cache *c, uint64_t addr) {
+    block *set = &c->shadow[((addr >> c->offsetBit) & (c->indexNum - 1)) * c->wayNum];
+    uint64_t tag = find_tag(c, addr);
+    block *victim = NULL;
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        if (set[i].valid && set[i].tag == tag) {
+            set[i].sectors |= sector_mask(c, addr);
+            return;
+        }
+    }
+    for (uint64_t i = 0; i < c->wayNum && victim == NULL; i++) {
+        if (!set[i].valid) {
+            victim = &set[i];
+        }
+    }
+    for (uint64_t i = 0; i < c->wayNum && (victim == NULL || victim->valid); i++) {
+        if (victim == NULL || set[i].history < victim->history ||
+            (set[i].history == victim->history && set[i].tag < victim->tag)) {
+            victim = &set[i];
+        }
+    }
+    victim->valid = true;
+    victim->tag = tag;
+    victim->sectors = sector_mask(c, addr);
+    shadow_touch(c, victim, true);
+}
+bool shadow_check(cache *c, uint64_t addr, bool allocate) {
+    block *set = &c->shadow[((addr >> c->offsetBit) & (c->indexNum - 1)) * c->wayNum];
+    uint64_t tag = find_tag(c, addr);
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        if (set[i].valid && set[i].tag == tag) {
+            bool hit = (set[i].sectors & sector_mask(c, addr)) != 0;
+            if (hit || allocate) {
+                set[i].sectors |= sector_mask(c, addr);
+                shadow_touch(c, &set[i], false);
+            }
+            return hit;
+        }
+    }
+    if (allocate) {
+        shadow_fill(c, addr);
+    }
+    return false;
+}
+
+//helper functions for way partitioning, classes are instructions, loads and stores
+uint64_t access_class(char type) {
+    return type == INST ? 0 : (type == LOAD ? 1 : 2);
+}
+uint64_t allowed_ways(cache *c) {
+    return c->class_ways[access_class(fill_type)] & c->core_ways[fill_core];
+}
+
+//helper functions for the write policy
+bool write_back(cache *c) {
+    return c->wp == WBWA || c->wp == WBWNA;
+}
+bool write_allocate(cache *c) {
+    return c->wp == WBWA || c->wp == WTWA;
+}
 
 /**
- * Function to check hit/miss in L1 cache
- * Returns hit/miss in boolean
+ * Function to account for the first demand hit on a prefetched block
  *
  */
-bool l1_check(uint64_t addr, char type, struct sim_stats_t *sim_stats) {
-    bool hit = false;
-    uint64_t tag;
-    uint64_t index;
-    switch (type) {
-        case 'I':
-            tag = find_tag_l1_inst(addr);
-            index = find_index_l1_inst(addr);
-            sim_stats->l1inst_num_accesses++;
-            for (uint64_t i = 0; i < wayNum_l1_inst; i++) {
-                if (l1_inst_cache[index][i].valid && l1_inst_cache[index][i].tag == tag) {
-                    hit = true;
-                    l1inst_update_rp(index, i);
-                    break;
-                }
-            }
-            if (!hit) {
-                sim_stats->l1inst_num_misses++;
-            }
-            break;
-        case 'S':
-            tag = find_tag_l1_data(addr);
-            index = find_index_l1_data(addr);
-            sim_stats->l1data_num_accesses++;
-            sim_stats->l1data_num_accesses_stores++;
-            for (uint64_t i = 0; i < wayNum_l1_data; i++) {
-                if (l1_data_cache[index][i].valid && l1_data_cache[index][i].tag == tag) {
-                    hit = true;
-                    //set dirty if not WTWNA
-                    if (wp != WTWNA) {
-                        l1_data_cache[index][i].dirty = true;    
-                    }
-                    l1data_update_rp(index, i);
-                    break;
-                }
-            }
-            if (!hit && wp != WTWNA) {
-                sim_stats->l1data_num_misses++;
-                sim_stats->l1data_num_misses_stores++;
-            }
-            break;
-        case 'L':
-            tag = find_tag_l1_data(addr);
-            index = find_index_l1_data(addr);
-            sim_stats->l1data_num_accesses++;
-            sim_stats->l1data_num_accesses_loads++;
-            for (uint64_t i = 0; i < wayNum_l1_data; i++) {
-                if (l1_data_cache[index][i].valid && l1_data_cache[index][i].tag == tag) {
-                    hit = true;
-                    l1data_update_rp(index, i);
-                    break;
-                }
-            }
-            if (!hit) {
-                sim_stats->l1data_num_misses++;
-                sim_stats->l1data_num_misses_loads++;
-            }
-            break;
+void prefetch_hit(block *b, struct prefetch_stats_t *pf_stats) {
+    b->prefetched = false;
+    pf_stats->num_useful++;
+    if (b->ready > cycle) {
+        pf_stats->num_late++;
     }
-    return hit;
 }
 
 /**
- * Function to check hit/miss in L2 cache
+ * Function to check hit/miss in a cache
+ * A store sets the dirty bit if write is set and the cache is write back.
+ * Store misses that do not allocate are not counted as misses
  * Returns hit/miss in boolean
  *
  */
-bool l2_check(uint64_t addr, char type, struct sim_stats_t *sim_stats) {
-    uint64_t tag = find_tag_l2(addr);
-    uint64_t index = find_index_l2(addr);
+bool cache_check(cache *c, uint64_t addr, char type, bool write, uint64_t size, struct sim_stats_t *sim_stats, bool *trigger) {
+    struct cache_stats_t *stats = &sim_stats->caches[c->id];
+    uint64_t tag = find_tag(c, addr);
+    uint64_t index = find_index(c, addr);
+    uint64_t sector = sector_mask(c, addr);
+    uint64_t predicted = c->way_pred != NULL ? c->way_pred[way_slot(c, addr)] : 0;
     bool hit = false;
-    sim_stats->l2unified_num_accesses++;
-    for (uint64_t i = 0; i < wayNum_l2;i++) {
-        if (l2_cache[index][i].valid && l2_cache[index][i].tag == tag) {
+    stats->num_accesses++;
+    //a miss is only known once every way has been probed
+    c->probe_time = c->fast_hit + (double)c->conf->mispredict_penalty;
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        uint64_t row = way_index(c, index, tag, i);
+        if (c->sets[row][i].valid && c->sets[row][i].tag == tag) {
+            if (!(c->sets[row][i].sectors & sector)) {
+                //the block is there but not the sector
+                stats->num_sector_misses++;
+                break;
+            }
             hit = true;
-            l2_update_rp(index,i);
+            c->sets[row][i].reused = true;
+            LOG_EVENT(EVENT_HIT, c, row, i, tag);
+            if (c->way_pred != NULL) {
+                //a hit outside the predicted way takes a second probe of every way
+                if (i == predicted) {
+                    stats->num_way_hits++;
+                    c->probe_time = c->fast_hit;
+                } else {
+                    stats->num_way_mispredictions++;
+                    way_train(c, addr, i);
+                }
+            }
+            //set dirty if the store stops here
+            if (write && write_back(c)) {
+                c->sets[row][i].dirty = true;
+                c->sets[row][i].dirty_bytes |= byte_mask(c, addr, size);
+            }
+            update_rp(c, row, i);
+            if (c->sets[row][i].prefetched) {
+                prefetch_hit(&c->sets[row][i], &stats->prefetch);
+                *trigger = true;
+            }
             break;
         }
     }
+    if (c->shadow != NULL) {
+        //the same access with bit-slice indexing, counted like the misses below
+        bool allocate = !(write && !write_allocate(c)) && (c->level == 0 || c->inclusion != EXCLUSIVE);
+        if (!shadow_check(c, addr, allocate) && !(write && !write_allocate(c))) {
+            stats->num_bit_slice_misses++;
+        }
+    }
+    if (c->classifier != NULL) {
+        //the shadow sees every access, only the misses the cache counts are classified
+        bool allocate = !(write && !write_allocate(c));
+        enum miss_class cls = classifier_access(c->classifier, addr >> c->sectorBit, allocate);
+        if (!hit && allocate) {
+            stats->num_class_misses[cls][access_class(type)]++;
+        }
+    }
+    if (c->an != NULL) {
+        analysis_access(c->an, addr >> c->offsetBit, index, !hit && !(write && !write_allocate(c)));
+    }
+    if (!hit) {
+        *trigger = true;
+        if (!(write && !write_allocate(c))) {
+            LOG_EVENT(EVENT_MISS, c, index, NO_WAY, tag);
+        }
+        if (c->partitioned) {
+            stats->num_core_misses[fill_core]++;
+        }
+        if (c->pf && prefetch_polluted(c->pf, addr >> c->offsetBit)) {
+            stats->prefetch.num_polluting++;
+        }
+    }
     switch (type) {
         case 'I':
-            sim_stats->l2unified_num_accesses_insts++;
+            stats->num_accesses_insts++;
             if (!hit) {
-                sim_stats->l2unified_num_misses_insts++;
-                sim_stats->l2unified_num_misses++;
+                stats->num_misses_insts++;
+                stats->num_misses++;
             }
-
             break;
         case 'S':
-            sim_stats->l2unified_num_accesses_stores++;
-            if (!hit && wp != WTWNA) {
-                sim_stats->l2unified_num_misses_stores++;
-                sim_stats->l2unified_num_misses++;
+            stats->num_accesses_stores++;
+            if (!hit && !(write && !write_allocate(c))) {
+                stats->num_misses_stores++;
+                stats->num_misses++;
             }
             break;
         case 'L':
-            sim_stats->l2unified_num_accesses_loads++;
+            stats->num_accesses_loads++;
             if (!hit) {
-                sim_stats->l2unified_num_misses_loads++;
-                sim_stats->l2unified_num_misses++;
+                stats->num_misses_loads++;
+                stats->num_misses++;
             }
             break;
     }
     return hit;
 }
 
-void mem_access(struct sim_stats_t *sim_stats) {
-    sim_stats->l2unified_num_bytes_transferred += (uint64_t)1 << offsetBit;
+/**
+ * Function to transfer one block or the sectors of one between the last level and main memory
+ * Returns the latency of the transfer in cycles
+ *
+ */
+uint64_t mem_access(uint64_t addr, bool write, int side, uint64_t bytes, struct sim_stats_t *sim_stats) {
+    cache *last = hierarchy[0][num_levels - 1][side];
+    sim_stats->caches[last->id].num_bytes_transferred += bytes;
+    if (mem_model == MEM_DRAM) {
+        return dram_access(addr, write, &cycle, sim_stats);
+    }
+    return (uint64_t)MEM_ACCESS_TIME;
 }
+
 /**
- * Function to load data blocks to L1 cache
- * Returns victim's info
+ * Helper functions to find a block without touching statistics or replacement state
+ * The line versions only match the tag, the others also need the sector of addr
+ * Returns NULL if the block is not present
  *
  */
-info l1_replace(uint64_t addr, char type, struct sim_stats_t *sim_stats) {
-    info victim;
-    victim.eviction = true;//assume there will be victim
-    victim.dirty = false;
-    victim.history = MAX;
-    victim.tag = MAX;
-    uint64_t index;
-    uint64_t tag;
-    switch (type) {
-        case 'I':
-            index = find_index_l1_inst(addr);
-            tag = find_tag_l1_inst(addr);
-            for (uint64_t i = 0; i < wayNum_l1_inst && victim.eviction; i++) {
-                //check invalid block
-                if (!l1_inst_cache[index][i].valid) {
-                    //found invalid block
-                    //no need for eviction
-                    victim.eviction = false;
-                    //set true
-                    l1_inst_cache[index][i].valid = true;
-                    //set tag
-                    l1_inst_cache[index][i].tag = tag;
-                    //set replacement policy
-                    l1inst_set_rp(index,i);
-                    break;
-                }
-                //find victim
-                if(l1_inst_cache[index][i].valid && l1_inst_cache[index][i].history <= victim.history) {
-                    //in case LFU tie, choose lowest tag
-                    if (l1_inst_cache[index][i].history == victim.history) {
-                        if (l1_inst_cache[index][i].tag < victim.tag) {
-                            victim.tag = l1_inst_cache[index][i].tag;
-                            victim.dirty = l1_inst_cache[index][i].dirty;
-                            victim.history = l1_inst_cache[index][i].history;
-                            victim.set = i;    
-                        }
-                    }
-                    else {
-                        victim.tag = l1_inst_cache[index][i].tag;
-                        victim.dirty = l1_inst_cache[index][i].dirty;
-                        victim.history = l1_inst_cache[index][i].history;
-                        victim.set = i;
-                    }
-                }
-            }
-            if (victim.eviction) {
-                sim_stats->l1inst_num_evictions++;
-                l1_inst_cache[index][victim.set].tag = tag;
-                l1inst_set_rp(index, victim.set);
-                victim.addr = restore_addr_l1_inst(victim.tag, index);
-            }
-            break;
+block* line_find(cache *c, uint64_t addr, uint64_t *way) {
+    uint64_t index = find_index(c, addr);
+    uint64_t tag = find_tag(c, addr);
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        uint64_t row = way_index(c, index, tag, i);
+        if (c->sets[row][i].valid && c->sets[row][i].tag == tag) {
+            *way = i;
+            return &c->sets[row][i];
+        }
+    }
+    return NULL;
+}
+block* cache_find(cache *c, uint64_t addr, uint64_t *way) {
+    block *b = line_find(c, addr, way);
+    return (b != NULL && (b->sectors & sector_mask(c, addr))) ? b : NULL;
+}
+block* vc_line_find(cache *c, uint64_t addr) {
+    for (uint64_t i = 0; i < c->vc.entries; i++) {
+        if (c->vc.blocks[i].valid && c->vc.blocks[i].tag == addr >> c->offsetBit)
+            return &c->vc.blocks[i];
+    }
+    return NULL;
+}
+block* vc_find(cache *c, uint64_t addr) {
+    block *b = vc_line_find(c, addr);
+    return (b != NULL && (b->sectors & sector_mask(c, addr))) ? b : NULL;
+}
 
-        case 'S':
-        case 'L':
-            index = find_index_l1_data(addr);
-            tag = find_tag_l1_data(addr);
-            for (uint64_t i = 0; i < wayNum_l1_data; i++) {
-                //check invalid block
-                if (!l1_data_cache[index][i].valid) {
-                    //found invalid block
-                    //set valid
-                    l1_data_cache[index][i].valid = true;
-                    //set tag
-                    l1_data_cache[index][i].tag = tag;
-                    //no need for eviction
-                    victim.eviction = false;
-                    victim.dirty = false;
-                    //set dirty if store
-                    if (type == 'S' && wp != WTWNA) {
-                        l1_data_cache[index][i].dirty = true;
-                    }
-                    //set replacement policy
-                    l1data_set_rp(index, i);
-                    break;
-                }
-                //find victim
-                if(l1_data_cache[index][i].valid && l1_data_cache[index][i].history <= victim.history) {
-                    //in case LFU tie, choose lowest tag
-                    if (l1_data_cache[index][i].history == victim.history) {
-                        if (l1_data_cache[index][i].tag < victim.tag) {
-                            victim.tag = l1_data_cache[index][i].tag;
-                            victim.dirty = l1_data_cache[index][i].dirty;
-                            victim.history = l1_data_cache[index][i].history;
-                            victim.set = i;    
-                        }
-                    }
-                    else {
-                        victim.tag = l1_data_cache[index][i].tag;
-                        victim.dirty = l1_data_cache[index][i].dirty;
-                        victim.history = l1_data_cache[index][i].history;
-                        victim.set = i;
-                    }
+/**
+ * Helper to find the blocks of a cache and its victim cache inside an aligned
+ * range no smaller than the cache's blocks, cleaning or invalidating them
+ * Returns the number of blocks found, dirty is set if one of them was dirty
+ *
+ */
+uint64_t range_blocks(cache *c, uint64_t addr, uint64_t bytes, bool clean, bool invalidate, bool *dirty) {
+    uint64_t found = 0;
+    uint64_t way;
+    addr &= ~(bytes - 1);
+    for (uint64_t a = addr; a < addr + bytes; a += (uint64_t)1 << c->offsetBit) {
+        block *copies[] = {line_find(c, a, &way), vc_line_find(c, a)};
+        for (int j = 0; j < 2; j++) {
+            if (copies[j] != NULL) {
+                found++;
+                *dirty = *dirty || copies[j]->dirty;
+                if (clean || invalidate) {
+                    copies[j]->dirty = false;
+                    copies[j]->dirty_bytes = 0;
                 }
-            }
-            if (victim.eviction) {
-                sim_stats->l1data_num_evictions++;
-                l1_data_cache[index][victim.set].tag = tag;
-                l1data_set_rp(index, victim.set);
-                l1_data_cache[index][victim.set].dirty = false;
-                victim.addr = restore_addr_l1_data(victim.tag, index);
-                //set dirty if store
-                if (type == 'S' && wp != WTWNA) {
-                    l1_data_cache[index][victim.set].dirty = true;
+                if (invalidate) {
+                    copies[j]->valid = false;
+                    copies[j]->sectors = 0;
                 }
             }
-            break;
+        }
     }
-    return victim;
+    return found;
+}
+
+/**
+ * Function to invalidate every copy of a block an inclusive cache evicts in the
+ * levels above it and their victim caches, in every core for a shared cache
+ * Returns true if one of the copies was dirty
+ *
+ */
+bool back_invalidate(cache *c, uint64_t addr, struct sim_stats_t *sim_stats) {
+    struct cache_stats_t *stats = &sim_stats->caches[c->id];
+    bool dirty = false;
+    for (uint64_t i = 0; i < num_caches; i++) {
+        if (caches[i].level >= c->level || (c->coherent && caches[i].core != c->core)) {
+            continue;
+        }
+        //the block may span several smaller blocks of the levels above
+        uint64_t found = range_blocks(&caches[i], addr, (uint64_t)1 << c->offsetBit, true, true, &dirty);
+        stats->num_back_invalidations += found;
+        if (found && caches[i].coherent) {
+            coherence_untrack(caches[i].core, addr);
+        }
+    }
+    if (dirty) {
+        stats->num_back_invalidation_write_backs++;
+    }
+    return dirty;
 }
+
 /**
- * Function to load data blocks to L2 cache
- * Returns victim's info
+ * Function to load a data block to a cache, dirty holds the bytes written to it
+ * Returns victim's info, index and set always point at the way that now holds the block
  *
  */
-info l2_replace(uint64_t addr, char type, struct sim_stats_t *sim_stats, bool dirty) {
+info cache_replace(cache *c, uint64_t addr, uint64_t dirty, struct sim_stats_t *sim_stats) {
     info victim;
     victim.eviction = true;//assume there will be victim
     victim.dirty = false;
     victim.history = MAX;
     victim.tag = MAX;
-    uint64_t index = find_index_l2(addr);
-    uint64_t tag = find_tag_l2(addr);
+    victim.sectorBit = c->sectorBit;
+    victim.chunkBit = c->chunkBit;
+    uint64_t index = find_index(c, addr);
+    uint64_t tag = find_tag(c, addr);
+    uint64_t sector = sector_mask(c, addr);
     victim.index = index;
+    uint64_t allowed = c->partitioned ? allowed_ways(c) : 0;
+    if (c->shadow != NULL) {
+        shadow_fill(c, addr);
+    }
 
-    for (uint64_t i = 0; i < wayNum_l2; i++) {
-        //search invalid block
-        if (!l2_cache[index][i].valid) {
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        //if a block already exists, at most a sector is missing
+        uint64_t row = way_index(c, index, tag, i);
+        if (c->sets[row][i].valid && c->sets[row][i].tag == tag) {
             victim.eviction = false;
-            l2_cache[index][i].valid = true;
-            l2_cache[index][i].dirty = dirty;
-            l2_cache[index][i].tag = tag;
-            l2_set_rp(index,i);
-            break;
+            victim.index = row;
+            victim.set = i;
+            c->sets[row][i].dirty = c->sets[row][i].dirty || dirty;
+            c->sets[row][i].sectors |= sector;
+            c->sets[row][i].dirty_bytes |= dirty;
+            update_rp(c, row, i);
+            return victim;
+        }
+    }
+    for (uint64_t i = 0; i < c->wayNum; i++) {
+        //search invalid block
+        uint64_t row = way_index(c, index, tag, i);
+        if (c->partitioned && !((allowed >> i) & 1)) {
+            continue;
         }
-        //if a block already exists
-        if (l2_cache[index][i].tag == tag) {
+        if (!c->sets[row][i].valid) {
             victim.eviction = false;
-            l2_cache[index][i].dirty = dirty;
-            l2_update_rp(index,i);
+            victim.index = row;
+            victim.set = i;
+            c->sets[row][i].valid = true;
+            c->sets[row][i].dirty = dirty;
+            c->sets[row][i].sectors = sector;
+            c->sets[row][i].dirty_bytes = dirty;
+            c->sets[row][i].tag = tag;
+            c->sets[row][i].prefetched = false;
+            c->sets[row][i].cls = access_class(fill_type);
+            c->sets[row][i].owner = fill_core;
+            c->sets[row][i].reused = false;
+            c->sets[row][i].predicted_dead = c->dbp != NULL && dbp_dead(c, addr);
+            set_rp(c, row, i);
+            insert_rp(c, index, tag, i);
+            LOG_EVENT(EVENT_FILL, c, row, i, tag);
+            way_train(c, addr, i);
             break;
         }
     }
     if (victim.eviction) {
-        for (uint64_t i = 0; i < wayNum_l2; i++) {
-            //search victim
-            if (l2_cache[index][i].valid && l2_cache[index][i].history <= victim.history) {
-                //check for tie
-                if (l2_cache[index][i].history == victim.history) {
-                    if (l2_cache[index][i].tag < victim.tag) {
-                        victim.tag = l2_cache[index][i].tag;
+        for (uint64_t i = 0; i < c->wayNum; i++) {
+            //search victim, only among the ways the fill may replace
+            uint64_t row = way_index(c, index, tag, i);
+            if (c->partitioned && !((allowed >> i) & 1)) {
+                continue;
+            }
+            if (c->sets[row][i].valid && c->sets[row][i].history <= victim.history) {
+                //in case of a tie, choose lowest tag
+                if (c->sets[row][i].history == victim.history) {
+                    if (c->sets[row][i].tag < victim.tag) {
+                        victim.tag = c->sets[row][i].tag;
+                        victim.index = row;
                         victim.set = i;
-                        victim.history = l2_cache[index][i].history;
-                        victim.dirty = l2_cache[index][i].dirty;
+                        victim.history = c->sets[row][i].history;
+                        victim.dirty = c->sets[row][i].dirty;
                     }
                 }
                 else {
-                    victim.tag = l2_cache[index][i].tag;
+                    victim.tag = c->sets[row][i].tag;
+                    victim.index = row;
                     victim.set = i;
-                    victim.history = l2_cache[index][i].history;
-                    victim.dirty = l2_cache[index][i].dirty;
+                    victim.history = c->sets[row][i].history;
+                    victim.dirty = c->sets[row][i].dirty;
                 }
             }
         }
-        sim_stats->l2unified_num_evictions++;
-        l2_cache[index][victim.set].tag = tag;
-        l2_cache[index][victim.set].dirty = dirty;
-        l2_set_rp(index,victim.set);
+        block *b = &c->sets[victim.index][victim.set];
+        sim_stats->caches[c->id].num_evictions++;
+        LOG_EVENT(EVENT_EVICT, c, victim.index, victim.set, victim.tag);
+        if (c->an != NULL) {
+            analysis_evict(c->an, victim.index);
+        }
+        victim.addr = restore_addr(c, victim.tag, victim.index, victim.set);
+        if (c->dbp != NULL) {
+            dbp_train(c, b, victim.addr, &sim_stats->caches[c->id]);
+        }
+        victim.sectors = b->sectors;
+        victim.dirty_bytes = b->dirty_bytes;
+        if (c->inclusion == INCLUSIVE && back_invalidate(c, victim.addr, sim_stats)) {
+            //keep the cache a superset of the levels above, a dirty upper copy is written back with the victim
+            victim.dirty = true;
+            victim.dirty_bytes = sector_chunks(c, victim.sectors);
+        }
+        b->tag = tag;
+        b->dirty = dirty;
+        b->sectors = sector;
+        b->dirty_bytes = dirty;
+        b->prefetched = false;
+        b->cls = access_class(fill_type);
+        b->owner = fill_core;
+        b->reused = false;
+        b->predicted_dead = c->dbp != NULL && dbp_dead(c, addr);
+        set_rp(c, victim.index, victim.set);
+        insert_rp(c, index, tag, victim.set);
+        LOG_EVENT(EVENT_FILL, c, victim.index, victim.set, tag);
+        way_train(c, addr, victim.set);
     }
     return victim;
 }
 
-
 /**
- * Function to initialize any data structures you might need for simulating the cache hierarchy. Use
- * the sim_conf structure for initializing dynamically allocated memory.
- *
- * @param sim_conf Pointer to simulation configuration structure
+ * Function to probe the victim cache of a cache on a miss
+ * A hit removes the block from the victim cache so it can be swapped back in
+ * Returns hit/miss in boolean
  *
  */
-void sim_init(struct sim_config_t *sim_conf)
-{
-    // TODO
-    //set MAX
-    //printf("***initialize start***\n");
-    MAX = ~MAX;
-
-    //initialize variables
-    offsetBit = sim_conf->l1data.b;
-    indexBit_l1_data = (uint64_t) sim_conf->l1data.c - sim_conf->l1data.b - sim_conf->l1data.s;
-    indexBit_l1_inst = (uint64_t) sim_conf->l1inst.c - sim_conf->l1inst.b - sim_conf->l1inst.s;
-    indexBit_l2 = (uint64_t) sim_conf->l2unified.c - sim_conf->l2unified.b - sim_conf->l2unified.s;
-    indexNum_l1_data = (uint64_t) pow(2, indexBit_l1_data);
-    indexNum_l1_inst = (uint64_t) pow(2, indexBit_l1_inst);
-    indexNum_l2 = (uint64_t) pow(2, indexBit_l2);
-    wayNum_l1_data = (uint64_t) pow(2, sim_conf->l1data.s);
-    wayNum_l1_inst = (uint64_t) pow(2, sim_conf->l1inst.s);
-    wayNum_l2 = (uint64_t) pow(2, sim_conf->l2unified.s);
-    tagBit_l1_data = 64 - indexBit_l1_data - offsetBit;
-    tagBit_l1_inst = 64 - indexBit_l1_inst - offsetBit;
-    tagBit_l2 = 64 - indexBit_l2 - offsetBit;
-    wp = sim_conf->wp;
-    rp = sim_conf->rp;
-    
-    //debugging
-    /*
-    printf("offsetBit: %llu\n", offsetBit);
-    printf("indexBit_l1_data: %llu\n", indexBit_l1_data);
-    printf("indexBit_l1_inst: %llu\n", indexBit_l1_inst);
-    printf("indexBit_l2: %llu\n", indexBit_l2);
-    printf("indexNum_l1_data: %llu\n", indexNum_l1_data);
-    printf("indexNum_l1_inst: %llu\n", indexNum_l1_inst);
-    printf("indexNum_l2: %llu\n", indexNum_l2);
-    printf("wayNum_l1_data: %llu\n", wayNum_l1_data);
-    printf("wayNum_l1_inst: %llu\n", wayNum_l1_inst);
-    printf("wayNum_l2: %llu\n", wayNum_l2);
-    printf("tagBit_l1_data: %llu\n", tagBit_l1_data);
-    printf("tagBit_l1_inst: %llu\n", tagBit_l1_inst);
-    printf("tagBit_l2: %llu\n", tagBit_l2);
-    */
-    //printf("max: %llu\n", MAX);
-    
-
-    //allocate space for cache
-
-    l1_data_cache = (block**) malloc(indexNum_l1_data * sizeof(block*));
-    l1_inst_cache = (block**) malloc(indexNum_l1_inst * sizeof(block*));
-    l2_cache = (block**) malloc(indexNum_l2 * sizeof(block*));
+bool vc_check(cache *c, uint64_t addr, struct sim_stats_t *sim_stats, block *entry) {
+    victim_cache *vc = &c->vc;
+    struct victim_stats_t *vc_stats = &sim_stats->caches[c->id].victim;
+    if (vc->entries == 0) {
+        return false;
+    }
+    vc_stats->num_accesses++;
+    block *b = vc_find(c, addr);
+    if (b != NULL) {
+        vc_stats->num_hits++;
+        *entry = *b;
+        b->valid = false;
+        return true;
+    }
+    return false;
+}
 
-    //initialize cache block variables
-    //printf("***l1_data***\n");
-    for (uint64_t i = 0; i < indexNum_l1_data; i++) {
-        l1_data_cache[i] = (block*) malloc (wayNum_l1_data * sizeof(block));
-        for (uint64_t j = 0; j < wayNum_l1_data; j++) {
-            l1_data_cache[i][j].valid = false;
-            l1_data_cache[i][j].dirty = false;
-            l1_data_cache[i][j].history = MAX;
+/**
+ * Function to place a victim in the victim cache of the cache that evicted it
+ * Returns the info of the block pushed out of the victim cache
+ *
+ */
+info vc_insert(cache *c, info cache_victim, struct sim_stats_t *sim_stats) {
+    victim_cache *vc = &c->vc;
+    info victim;
+    victim.eviction = true;//assume there will be victim
+    victim.dirty = false;
+    victim.history = MAX;
+    victim.set = 0;
+    for (uint64_t i = 0; i < vc->entries; i++) {
+        //free entry
+        if (!vc->blocks[i].valid) {
+            victim.eviction = false;
+            victim.set = i;
+            break;
         }
-    }
-    //printf("***l1_inst***\n");
-    for (uint64_t i = 0; i < indexNum_l1_inst; i++) {
-        l1_inst_cache[i] = (block*) malloc (wayNum_l1_inst * sizeof(block));
-        for (uint64_t j = 0; j < wayNum_l1_inst; j++) {
-            l1_inst_cache[i][j].valid = false;
-            l1_inst_cache[i][j].dirty = false;
-            l1_inst_cache[i][j].history = MAX;
+        //least recently inserted entry
+        if (vc->blocks[i].history < victim.history) {
+            victim.history = vc->blocks[i].history;
+            victim.set = i;
         }
     }
-    //printf("***l2***\n");
-    for (uint64_t i = 0; i < indexNum_l2; i++) {
-        l2_cache[i] = (block*) malloc (wayNum_l2 * sizeof(block));
-        for (uint64_t j = 0; j < wayNum_l2; j++) {
-            l2_cache[i][j].valid = false;
-            l2_cache[i][j].dirty = false;
-            l2_cache[i][j].history = MAX;
-        }
+    block *b = &vc->blocks[victim.set];
+    if (victim.eviction) {
+        sim_stats->caches[c->id].victim.num_evictions++;
+        victim.dirty = b->dirty;
+        victim.addr = b->tag << c->offsetBit;
+        victim.sectors = b->sectors;
+        victim.dirty_bytes = b->dirty_bytes;
+        victim.sectorBit = c->sectorBit;
+        victim.chunkBit = c->chunkBit;
     }
-    //printf("***initialize end***\n");
+    count++;
+    b->valid = true;
+    b->dirty = cache_victim.dirty;
+    b->sectors = cache_victim.sectors;
+    b->dirty_bytes = cache_victim.dirty_bytes;
+    b->tag = cache_victim.addr >> c->offsetBit;
+    b->history = count;
+    return victim;
 }
 
 /**
- * Function to perform cache accesses, one access at a time. The print_debug function should be called
- * if the debug flag is true
+ * Function to pass a block a cache gives up on to the next level, or to main
+ * memory below the last level. Only dirty blocks are saved, unless the next
+ * level is exclusive and takes every block the level above gives up. A write
+ * back only moves the bytes that were written
  *
- * @param addr The address being accessed by the processor
- * @param type The type of access - Load (L), Store (S) or Instruction (I)
- * @param sim_stats Pointer to simulation statistics structure - Should be populated here
- * @param sim_conf Pointer to the simulation configuration structure - Don't modify it in this function
+ */
+void send_down(cache *c, info victim, uint64_t addr, bool *filled, struct sim_stats_t *sim_stats) {
+    struct cache_stats_t *stats = &sim_stats->caches[c->id];
+    if (c->level + 1 == num_levels) {
+        if (victim.dirty) {
+            //write back
+            stats->num_write_backs++;
+            LOG_EVENT(EVENT_WRITE_BACK, c, find_index(c, victim.addr), NO_WAY, find_tag(c, victim.addr));
+            mem_access(victim.addr, true, c->side, sector_bytes(victim.dirty_bytes, victim.chunkBit), sim_stats);
+        }
+        return;
+    }
+    cache *next = hierarchy[c->core][c->level + 1][c->side];
+    if (victim.dirty || next->inclusion == EXCLUSIVE) {
+        if (victim.dirty) {
+            stats->num_write_backs++;
+            LOG_EVENT(EVENT_WRITE_BACK, c, find_index(c, victim.addr), NO_WAY, find_tag(c, victim.addr));
+        }
+        if (next->inclusion == EXCLUSIVE) {
+            stats->num_bytes_transferred += sector_bytes(victim.sectors, victim.sectorBit);
+        } else {
+            stats->num_bytes_transferred += sector_bytes(victim.dirty_bytes, victim.chunkBit);
+        }
+        //a victim is filled for its core as a store if dirty, by its side otherwise
+        char type = fill_type;
+        uint64_t core = fill_core;
+        fill_type = victim.dirty ? STORE : (c->side == 0 ? INST : LOAD);
+        fill_core = c->coherent ? c->core : fill_core;
+        cache_insert(next, victim, addr, filled, sim_stats);
+        fill_type = type;
+        fill_core = core;
+    }
+}
+
+/**
+ * Function to dispose of a block evicted from a cache
+ * With a victim cache the block goes there and whatever the victim cache pushes
+ * out continues to the next level
+ *
+ */
+void cache_evict(cache *c, info victim, uint64_t addr, bool *filled, struct sim_stats_t *sim_stats) {
+    if (!victim.eviction) {
+        return;
+    }
+    if (c->vc.entries) {
+        victim = vc_insert(c, victim, sim_stats);
+        if (!victim.eviction) {
+            return;
+        }
+        if (victim.dirty) {
+            sim_stats->caches[c->id].victim.num_write_backs++;
+        }
+    }
+    send_down(c, victim, addr, filled, sim_stats);
+    if (c->coherent) {
+        coherence_untrack(c->core, victim.addr);
+    }
+}
+
+/**
+ * Function to save a victim of the level above in a cache
+ * If the cache filled the block of addr during this access (filled is set for its
+ * level), that block is kept from being chosen as the victim
+ *
+ */
+void cache_insert(cache *c, info victim, uint64_t addr, bool *filled, struct sim_stats_t *sim_stats) {
+    if (victim.dirty && !write_back(c)) {
+        //a write-through cache writes the dirty data on down
+        LOG_EVENT(EVENT_WRITE_THROUGH, c, find_index(c, victim.addr), NO_WAY, find_tag(c, victim.addr));
+        send_down(c, victim, addr, filled, sim_stats);
+        victim.dirty = false;
+        if (!write_allocate(c) && c->inclusion != EXCLUSIVE) {
+            return;
+        }
+    }
+    info next_victim;
+    uint64_t way;
+    if (c->banks != NULL) {
+        //the write back holds a bank, it only delays the accesses behind it
+        bank_access(c, victim.addr, cycle, sim_stats);
+    }
+    uint64_t dirty = victim.dirty ? remap_bytes(victim.dirty_bytes, victim.addr, victim.chunkBit, c, victim.addr) : 0;
+    block *b = (filled[c->level] && c->rp == LFU) ? cache_find(c, addr, &way) : NULL;
+    if (b != NULL) {
+        //for LFU
+        //set MRU history to MAX to prevent eviction
+        //special thanks to TAs 
+        tmp = b->history;
+        b->history = MAX;
+        LOG_EVENT(EVENT_LFU_PROTECT, c, way_index(c, find_index(c, addr), b->tag, way), way, b->tag);
+        next_victim = cache_replace(c, victim.addr, dirty, sim_stats);
+        b->history = tmp;
+    }
+    else {
+        next_victim = cache_replace(c, victim.addr, dirty, sim_stats);
+    }
+    cache_evict(c, next_victim, addr, filled, sim_stats);
+}
+
+/**
+ * Helper to check if a core still holds a block in its private levels
+ *
+ */
+bool held_privately(uint64_t core, uint64_t addr) {
+    bool dirty = false;
+    for (uint64_t k = 0; k < num_private; k++) {
+        for (int side = 0; side < 2; side++) {
+            if (range_blocks(hierarchy[core][k][side], addr, (uint64_t)1 << dirShift, false, false, &dirty))
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function to record in the directory that a core holds a block after an access
+ * A sole holder owns the block (E, or M once it writes it), more holders share it (S)
+ *
+ */
+void coherence_track(uint64_t core, uint64_t addr) {
+    if (!held_privately(core, addr)) {
+        return;
+    }
+    int64_t owner;
+    uint64_t blk = addr >> dirShift;
+    uint64_t bit = (uint64_t)1 << core;
+    uint64_t sharers = directory_lookup(dir, blk, &owner) | bit;
+    directory_update(dir, blk, sharers, sharers == bit ? (int64_t)core : -1);
+}
+
+/**
+ * Function to drop a core from the sharers of a block once its private levels gave it up
+ *
+ */
+void coherence_untrack(uint64_t core, uint64_t addr) {
+    if (held_privately(core, addr)) {
+        return;
+    }
+    int64_t owner;
+    uint64_t blk = addr >> dirShift;
+    uint64_t bit = (uint64_t)1 << core;
+    uint64_t sharers = directory_lookup(dir, blk, &owner);
+    if (sharers & bit) {
+        directory_update(dir, blk, sharers & ~bit, owner == (int64_t)core ? -1 : owner);
+    }
+}
+
+/**
+ * Function to clean or invalidate every private copy a core holds of a block
+ * Modified data is forwarded to the requesting core through the first shared level
+ * Returns true if a copy was modified
+ *
+ */
+bool coherence_recall(uint64_t core, uint64_t addr, bool invalidate, bool *filled, struct sim_stats_t *sim_stats) {
+    bool dirty = false;
+    for (uint64_t k = 0; k < num_private; k++) {
+        for (int side = 0; side < 2; side++) {
+            cache *c = hierarchy[core][k][side];
+            if (side == 1 && c == hierarchy[core][k][0]) {
+                continue;
+            }
+            range_blocks(c, addr, (uint64_t)1 << dirShift, true, invalidate, &dirty);
+        }
+    }
+    if (dirty) {
+        cache *last = hierarchy[core][num_private - 1][1];
+        info victim;
+        victim.eviction = true;
+        victim.dirty = true;
+        victim.addr = (addr >> dirShift) << dirShift;
+        victim.sectors = all_sectors(last);
+        victim.dirty_bytes = sector_chunks(last, victim.sectors);
+        victim.sectorBit = last->sectorBit;
+        victim.chunkBit = last->chunkBit;
+        send_down(last, victim, addr, filled, sim_stats);
+        sim_stats->cores[core].num_c2c_transfers++;
+    }
+    return dirty;
+}
+
+/**
+ * Function to handle a request leaving a core's private levels at the directory
+ * A load makes the core owning the block drop to shared. A store invalidates
+ * every other copy, and is an upgrade if the core held a shared copy itself
+ *
+ */
+void coherence_request(uint64_t core, uint64_t addr, bool write, bool *filled, struct sim_stats_t *sim_stats) {
+    int64_t owner;
+    uint64_t blk = addr >> dirShift;
+    uint64_t bit = (uint64_t)1 << core;
+    uint64_t sharers = directory_lookup(dir, blk, &owner);
+    if (write) {
+        if ((sharers & bit) && owner != (int64_t)core) {
+            sim_stats->cores[core].num_upgrades++;
+        }
+        for (uint64_t others = sharers & ~bit; others; others &= others - 1) {
+            uint64_t other = __builtin_ctzll(others);
+            coherence_recall(other, addr, true, filled, sim_stats);
+            sim_stats->cores[other].num_invalidations++;
+        }
+        directory_update(dir, blk, sharers & bit, (sharers & bit) ? (int64_t)core : -1);
+    }
+    else if (owner >= 0 && owner != (int64_t)core) {
+        coherence_recall(owner, addr, false, filled, sim_stats);
+        directory_update(dir, blk, sharers, -1);
+    }
+}
+
+/**
+ * Function to load a block into the levels above the one that supplied it, from
+ * the bottom up. alloc marks the levels that take the block and dirty the level
+ * that keeps the store. An exclusive level that supplied the block hands it over
+ * to the closest level that takes it. A prefetch marks the block once it lands
+ * in pf_target
+ *
+ */
+void fill_up(uint64_t core, uint64_t addr, int side, uint64_t from, const bool *alloc, const uint64_t *dirty, bool *filled,
+             cache *pf_target, uint64_t ready, struct sim_stats_t *sim_stats) {
+    int64_t receiver = -1;
+    for (int64_t j = (int64_t)from - 1; j >= 0 && receiver < 0; j--) {
+        if (alloc[j]) {
+            receiver = j;
+        }
+    }
+    uint64_t moved_dirty = 0;
+    if (from < num_levels && receiver >= 0 && hierarchy[core][from][side]->inclusion == EXCLUSIVE) {
+        //the block moves up, the exclusive level gives up its copy
+        uint64_t way;
+        cache *source = hierarchy[core][from][side];
+        cache *target = hierarchy[core][receiver][side];
+        uint64_t sector = sector_mask(source, addr);
+        block *b = cache_find(source, addr, &way);
+        //a block bigger than the receiver's stays, the receiver only takes part of it
+        if (b != NULL && source->sectorBit <= target->offsetBit) {
+            uint64_t written = b->dirty_bytes & sector_chunks(source, sector);
+            if (!written || write_back(target)) {
+                moved_dirty = remap_bytes(written, (addr >> source->offsetBit) << source->offsetBit, source->chunkBit, target, addr);
+                b->sectors &= ~sector;
+                b->dirty_bytes &= ~written;
+                b->dirty = b->dirty_bytes != 0;
+                b->valid = b->sectors != 0;
+            }
+        }
+    }
+    for (int64_t j = (int64_t)from - 1; j >= 0; j--) {
+        if (!alloc[j]) {
+            continue;
+        }
+        cache *c = hierarchy[core][j][side];
+        info victim = cache_replace(c, addr, dirty[j] | (j == receiver ? moved_dirty : 0), sim_stats);
+        filled[j] = true;
+        if (j + 1 < (int64_t)num_levels) {
+            sim_stats->caches[c->id].num_bytes_transferred += (uint64_t)1 << c->sectorBit;
+        }
+        if (c == pf_target) {
+            c->sets[victim.index][victim.set].prefetched = true;
+            c->sets[victim.index][victim.set].ready = ready;
+            if (victim.eviction) {
+                prefetch_evicted(c->pf, victim.addr >> c->offsetBit);
+            }
+        }
+        //make sure not to evict just added block
+        cache_evict(c, victim, addr, filled, sim_stats);
+    }
+}
+
+/**
+ * Function to prefetch a block into a cache through the levels below it
+ * Fills go through cache_replace exactly like a demand miss,
+ * but no demand statistics are counted
+ *
+ */
+void prefetch_fill(cache *c, uint64_t addr, struct sim_stats_t *sim_stats) {
+    uint64_t way;
+    if (cache_find(c, addr, &way) != NULL) {
+        return;
+    }
+    sim_stats->caches[c->id].prefetch.num_issued++;
+
+    //find the block in the levels below, or bring it in from main memory
+    bool alloc[MAX_LEVELS] = {false};
+    uint64_t dirty[MAX_LEVELS] = {0};
+    bool filled[MAX_LEVELS] = {false};
+    uint64_t latency = 0;
+    uint64_t k;
+    if (c->coherent) {
+        coherence_request(c->core, addr, false, filled, sim_stats);
+    }
+    alloc[c->level] = true;
+    for (k = c->level + 1; k < num_levels; k++) {
+        cache *lower = hierarchy[c->core][k][c->side];
+        latency += (uint64_t)sim_stats->caches[lower->id].hit_time;
+        if (cache_find(lower, addr, &way) != NULL) {
+            update_rp(lower, way_index(lower, find_index(lower, addr), find_tag(lower, addr), way), way);
+            break;
+        }
+        alloc[k] = lower->inclusion != EXCLUSIVE;
+    }
+    if (k == num_levels) {
+        cache *last = hierarchy[c->core][num_levels - 1][c->side];
+        latency += mem_access(addr, false, c->side, (uint64_t)1 << last->sectorBit, sim_stats);
+    }
+    fill_up(c->core, addr, c->side, k, alloc, dirty, filled, c, cycle + latency, sim_stats);
+    if (c->coherent) {
+        coherence_track(c->core, addr);
+    }
+}
+
+/**
+ * Function to train a cache's prefetcher on a trigger and issue the blocks it asks for
+ *
+ */
+void issue_prefetches(cache *c, uint64_t addr, struct sim_stats_t *sim_stats) {
+    uint64_t candidates[MAX_PREFETCH_DEGREE];
+    uint64_t n = prefetch_train(c->pf, addr >> c->offsetBit, candidates);
+    for (uint64_t i = 0; i < n; i++) {
+        prefetch_fill(c, candidates[i] << c->offsetBit, sim_stats);
+    }
+}
+
+/**
+ * Function to set up one cache of the hierarchy
+ * Returns the cache
+ *
+ */
+cache* init_cache(uint64_t level, uint64_t core, int side, const struct level_config_t *level_conf, const struct cache_config_t *conf) {
+    cache *c = &caches[num_caches];
+    c->id = num_caches++;
+    c->level = level;
+    c->core = core;
+    c->coherent = num_cores > 1 && level_conf->sharing == PRIVATE;
+    c->side = side;
+    c->conf = conf;
+    c->offsetBit = conf->b;
+    c->sectorNum = conf->sectors;
+    c->sectorBit = conf->b - __builtin_ctzll(conf->sectors);
+    c->chunkBit = conf->b > 6 ? conf->b - 6 : 0;
+    c->indexBit = conf->c - conf->b - conf->s;
+    c->indexNum = (uint64_t) pow(2, c->indexBit);
+    c->wayNum = (uint64_t) pow(2, conf->s);
+    c->tagBit = 64 - c->indexBit - c->offsetBit;
+    c->wp = level_conf->wp;
+    c->rp = level_conf->rp;
+    //the first level has nothing above it to include or exclude
+    c->inclusion = level == 0 ? NINE : level_conf->inclusion;
+    //a single set has nothing to hash
+    c->indexing = c->indexBit ? conf->indexing : BIT_SLICE;
+    c->shadow = c->indexing != BIT_SLICE ? (block*) calloc(c->indexNum * c->wayNum, sizeof(block)) : NULL;
+    c->shadow_count = 0;
+    c->insertion = conf->insertion;
+    c->bip_count = 0;
+    c->dbp = conf->bypass ? (uint8_t*) calloc((uint64_t)1 << DBP_ENTRIES_BITS, sizeof(uint8_t)) : NULL;
+    c->classifier = classify_misses ? classifier_create(c->indexNum * c->wayNum * c->sectorNum) : NULL;
+    c->an = analysis_conf.file[0] ? analysis_create(c->indexNum, c->offsetBit) : NULL;
+    c->banks = NULL;
+    c->bankShift = conf->bank_bit ? conf->bank_bit : conf->b;
+    if (conf->banks > 1) {
+        c->banks = (cache_bank*) malloc(conf->banks * sizeof(cache_bank));
+        for (uint64_t i = 0; i < conf->banks; i++) {
+            c->banks[i].ready = 0;
+            c->banks[i].queue = (uint64_t*) calloc(conf->bank_queue, sizeof(uint64_t));
+            c->banks[i].head = 0;
+        }
+    }
+    c->way_pred = NULL;
+    c->fast_hit = 0;
+    c->probe_time = 0;
+    if (conf->way_pred != NO_WAY_PREDICTION) {
+        uint64_t slots = conf->way_pred == WAY_PREDICT_MRU ? c->indexNum : (uint64_t)1 << WAY_TABLE_BITS;
+        c->way_pred = (uint32_t*) calloc(slots, sizeof(uint32_t));
+        //without a fast hit time the predicted way is as quick as a direct mapped cache
+        struct cache_config_t dm = *conf;
+        dm.s = 0;
+        c->fast_hit = conf->fast_hit_time ? (double)conf->fast_hit_time : level_hit_time(level_conf, &dm);
+    }
+    //a mask of 0 leaves every way to the class or core
+    c->partitioned = false;
+    for (uint64_t i = 0; i < 3; i++) {
+        c->class_ways[i] = conf->class_ways[i] ? conf->class_ways[i] : ~(uint64_t)0;
+        c->partitioned = c->partitioned || conf->class_ways[i];
+    }
+    for (uint64_t i = 0; i < MAX_CORES; i++) {
+        c->core_ways[i] = conf->core_ways[i] ? conf->core_ways[i] : ~(uint64_t)0;
+        c->partitioned = c->partitioned || conf->core_ways[i];
+    }
+
+    //allocate space for cache
+    c->sets = (block**) malloc(c->indexNum * sizeof(block*));
+
+    //initialize cache block variables
+    for (uint64_t i = 0; i < c->indexNum; i++) {
+        c->sets[i] = (block*) malloc(c->wayNum * sizeof(block));
+        for (uint64_t j = 0; j < c->wayNum; j++) {
+            c->sets[i][j].valid = false;
+            c->sets[i][j].dirty = false;
+            c->sets[i][j].prefetched = false;
+            c->sets[i][j].cls = 0;
+            c->sets[i][j].owner = 0;
+            c->sets[i][j].reused = false;
+            c->sets[i][j].predicted_dead = false;
+            c->sets[i][j].sectors = 0;
+            c->sets[i][j].dirty_bytes = 0;
+            c->sets[i][j].history = MAX;
+        }
+    }
+    c->vc.entries = conf->vc_entries;
+    c->vc.blocks = (block*) calloc(c->vc.entries, sizeof(block));
+    c->wbuf.entries = conf->wb_entries;
+    c->wbuf.used = 0;
+    c->wbuf.ready = 0;
+    c->wbuf.slots = (wb_entry*) calloc(c->wbuf.entries, sizeof(wb_entry));
+    c->pf = prefetch_create(conf);
+    return c;
+}
+
+// Open the time series and event log of the run
+static void outputs_open(const struct sim_config_t *sim_conf) {
+    series = sim_conf->timeseries.file[0] ? timeseries_create(&sim_conf->timeseries, num_caches) : NULL;
+    event_log = NULL;
+#ifndef CACHESIM_NO_EVENTS
+    if (sim_conf->event_log[0]) {
+        uint8_t levels[MAX_CACHES];
+        for (uint64_t i = 0; i < num_caches; i++) {
+            levels[i] = (uint8_t)caches[i].level;
+        }
+        event_log = event_log_open(sim_conf->event_log, num_caches, levels);
+    }
+#endif
+}
+
+/**
+ * Function to initialize any data structures you might need for simulating the cache hierarchy. Use
+ * the sim_conf structure for initializing dynamically allocated memory.
+ *
+ * @param sim_conf Pointer to simulation configuration structure
+ *
+ */
+void sim_init(struct sim_config_t *sim_conf)
+{
+    //set MAX
+    MAX = ~MAX;
+
+    //initialize variables
+    mem_model = sim_conf->mem.model;
+    issue_interval = sim_conf->issue_interval;
+    classify_misses = sim_conf->classify_misses;
+    latency_histogram = sim_conf->latency_histogram;
+    analysis_conf = sim_conf->analysis;
+    num_levels = sim_conf->num_levels;
+    num_cores = sim_conf->cores;
+    num_caches = 0;
+    for (num_private = 0; num_private < num_levels && sim_conf->levels[num_private].sharing == PRIVATE; num_private++);
+    for (uint64_t k = 0; k < num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        //a private level gets a copy per core, a shared one is built once
+        uint64_t copies = level->sharing == PRIVATE ? num_cores : 1;
+        for (uint64_t core = 0; core < copies; core++) {
+            if (level->split) {
+                hierarchy[core][k][0] = init_cache(k, core, 0, level, &level->inst);
+                hierarchy[core][k][1] = init_cache(k, core, 1, level, &level->data);
+            }
+            else {
+                hierarchy[core][k][1] = init_cache(k, core, 1, level, &level->data);
+                hierarchy[core][k][0] = hierarchy[core][k][1];
+            }
+        }
+        for (uint64_t core = copies; core < num_cores; core++) {
+            hierarchy[core][k][0] = hierarchy[0][k][0];
+            hierarchy[core][k][1] = hierarchy[0][k][1];
+        }
+    }
+    outputs_open(sim_conf);
+    //the directory tracks blocks of the biggest private block size
+    dirShift = sim_conf->levels[0].data.b;
+    for (uint64_t k = 0; k < num_private; k++) {
+        dirShift = sim_conf->levels[k].data.b > dirShift ? sim_conf->levels[k].data.b : dirShift;
+        dirShift = sim_conf->levels[k].split && sim_conf->levels[k].inst.b > dirShift ? sim_conf->levels[k].inst.b : dirShift;
+    }
+    dir = num_cores > 1 ? directory_create() : NULL;
+    vm = sim_conf->vm;
+    pt = NULL;
+    if (vm.page) {
+        pt = page_table_create(PAGE_BITS[vm.page]);
+        for (uint64_t core = 0; core < num_cores; core++) {
+            tlbs[core][0] = tlb_create(&vm.itlb);
+            tlbs[core][1] = tlb_create(&vm.dtlb);
+            tlbs[core][2] = tlb_create(&vm.stlb);
+        }
+    }
+    if (mem_model == MEM_DRAM) {
+        dram_init(sim_conf);
+    }
+}
+
+/**
+ * Function to start the outputs over once the caches are warmed up, so the time series,
+ * analysis and event log only cover the accesses counted in the statistics
+ *
+ * @param sim_conf The simulation configuration
+ */
+void sim_warm_up_end(const struct sim_config_t *sim_conf)
+{
+    timeseries_discard(series);
+    event_log_close(event_log);
+    outputs_open(sim_conf);
+    for (uint64_t i = 0; i < num_caches; i++) {
+        cache *c = &caches[i];
+        if (c->an != NULL) {
+            analysis_destroy(c->an);
+            c->an = analysis_create(c->indexNum, c->offsetBit);
+        }
+    }
+}
+
+/**
+ * Function to perform cache accesses, one access at a time. The print_debug function should be called
+ * if the debug flag is true
+ *
+ * @param addr The address being accessed by the processor
+ * @param type The type of access - Load (L), Store (S) or Instruction (I)
+ * @param sim_stats Pointer to simulation statistics structure - Should be populated here
+ * @param sim_conf Pointer to the simulation configuration structure - Don't modify it in this function
  */
 void cache_access(uint64_t addr, char type, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
 {
-    bool l1_hit;
-    bool l2_hit;
-    info l1_victim;
-    info l2_victim1;
-    info l2_victim2;
-
-
-    //check L1 cache
-    l1_hit = l1_check(addr, type, sim_stats);
-    if (!l1_hit || (type == 'S' && wp == WTWNA)) {
-        //L1 MISS
-        l2_hit = l2_check(addr, type, sim_stats);
-        if ((type == 'S' && wp == WTWNA)) {
-            //just write through
-            mem_access(sim_stats);
-        }
-        else if(l2_hit) {
-            //L2 HIT
-            //load to L1
-            l1_victim = l1_replace(addr, type, sim_stats);
-            //if there is dirty vicitm from L1
-            if (l1_victim.eviction && l1_victim.dirty) {
-                //save dirty victim in L2
-                l2_victim1 = l2_replace(l1_victim.addr, type, sim_stats, true);
-                //if there is dirty victim from L2
-                if (l2_victim1.eviction && l2_victim1.dirty) {
-                    //write back
-                    sim_stats->l2unified_num_write_backs++;
-                    mem_access(sim_stats);
-                }
+    core_access(0, addr, type, 0, sim_stats, sim_conf);
+}
+
+/**
+ * Function to write the oldest entry of a write buffer to the levels below its
+ * cache, one store per run of written bytes. The entry starts once the next
+ * level is done with the one before it
+ * Returns the cycle the next level is free again
+ *
+ */
+uint64_t buffer_drain(uint64_t core, cache *c, struct sim_stats_t *sim_stats) {
+    struct write_buffer_stats_t *stats = &sim_stats->caches[c->id].write_buffer;
+    wb_entry e = c->wbuf.slots[0];
+    uint64_t base = e.addr << c->offsetBit;
+    uint64_t now = cycle;
+    double latency = 0;
+    c->wbuf.used--;
+    memmove(c->wbuf.slots, c->wbuf.slots + 1, c->wbuf.used * sizeof(wb_entry));
+    stats->num_drains++;
+    stats->num_bytes_drained += sector_bytes(e.bytes, c->chunkBit);
+    cycle = c->wbuf.ready > e.cycle ? c->wbuf.ready : e.cycle;
+    while (e.bytes) {
+        uint64_t first = __builtin_ctzll(e.bytes);
+        uint64_t run = ~(e.bytes >> first);
+        uint64_t len = run ? __builtin_ctzll(run) : 64 - first;
+        latency += hierarchy_access(core, c->level + 1, base + (first << c->chunkBit), STORE, len << c->chunkBit, sim_stats);
+        e.bytes &= ~bit_range(first, first + len - 1);
+    }
+    c->wbuf.ready = cycle + (uint64_t)(latency + 0.5);
+    cycle = now;
+    return c->wbuf.ready;
+}
+
+/**
+ * Function to put a store leaving a cache in its write buffer, merging it into
+ * the entry of its block if there is one. Entries drain in the background while
+ * the next level is free, a full buffer makes the store wait for the oldest one
+ * and moves the core's clock forward
+ * Returns the cycles the store waited for the buffer
+ *
+ */
+double buffer_store(uint64_t core, cache *c, uint64_t addr, uint64_t size, struct sim_stats_t *sim_stats) {
+    struct write_buffer_stats_t *stats = &sim_stats->caches[c->id].write_buffer;
+    uint64_t blk = addr >> c->offsetBit;
+    uint64_t bytes = byte_mask(c, addr, size);
+    uint64_t stall = 0;
+    while (c->wbuf.used && (c->wbuf.ready > c->wbuf.slots[0].cycle ? c->wbuf.ready : c->wbuf.slots[0].cycle) <= cycle) {
+        buffer_drain(core, c, sim_stats);
+    }
+    stats->num_writes++;
+    stats->num_bytes_written += sector_bytes(bytes, c->chunkBit);
+    for (uint64_t i = 0; i < c->wbuf.used; i++) {
+        if (c->wbuf.slots[i].addr == blk) {
+            c->wbuf.slots[i].bytes |= bytes;
+            stats->num_merges++;
+            return 0;
+        }
+    }
+    if (c->wbuf.used == c->wbuf.entries) {
+        uint64_t ready = buffer_drain(core, c, sim_stats);
+        stall = ready > cycle ? ready - cycle : 0;
+        stats->num_full_stalls++;
+        stats->num_stall_cycles += stall;
+        cycle += stall;
+    }
+    c->wbuf.slots[c->wbuf.used].addr = blk;
+    c->wbuf.slots[c->wbuf.used].bytes = bytes;
+    c->wbuf.slots[c->wbuf.used].cycle = cycle;
+    c->wbuf.used++;
+    return (double)stall;
+}
+
+/**
+ * Function to access the cache hierarchy of one core with a physical address,
+ * starting at level from. Private levels are the core's own, the levels below
+ * are shared with the other cores and kept coherent by the directory
+ * Returns the latency of the access in cycles
+ *
+ */
+double hierarchy_access(uint64_t core, uint64_t from, uint64_t addr, char type, uint64_t size, struct sim_stats_t *sim_stats)
+{
+    int side = (type == 'I') ? 0 : 1;
+    bool write = (type == 'S'); //the store still has to be written somewhere
+    bool trigger[MAX_LEVELS] = {false};
+    bool alloc[MAX_LEVELS] = {false};
+    uint64_t dirty[MAX_LEVELS] = {0};
+    bool filled[MAX_LEVELS] = {false};
+    int64_t found = -1;
+    bool fetch = false;
+    bool requested = false;
+    block entry;
+    double latency = 0;
+    uint64_t k;
+    char type_before = fill_type;
+    uint64_t core_before = fill_core;
+    fill_type = type;
+    fill_core = core;
+
+    //check the caches level by level
+    for (k = from; k < num_levels; k++) {
+        cache *c = hierarchy[core][k][side];
+        if (k == num_private && dir != NULL) {
+            //the request leaves the core, the directory deals with the other copies
+            coherence_request(core, addr, type == 'S', filled, sim_stats);
+            requested = true;
+        }
+        bool around = write && !write_allocate(c);
+        if (c->banks != NULL) {
+            latency += (double)bank_access(c, addr, cycle + (uint64_t)(latency + 0.5), sim_stats);
+        }
+        bool hit = cache_check(c, addr, type, write, size, sim_stats, &trigger[k]);
+        if (write && !write_back(c)) {
+            LOG_EVENT(EVENT_WRITE_THROUGH, c, find_index(c, addr), NO_WAY, find_tag(c, addr));
+        }
+        latency += c->way_pred != NULL ? c->probe_time : sim_stats->caches[c->id].hit_time;
+        if (!hit && !around && c->vc.entries) {
+            latency += (double)c->conf->vc_hit_time;
+        }
+        if (!hit && !around && vc_check(c, addr, sim_stats, &entry)) {
+            //VICTIM CACHE HIT
+            //swap the block back in with all its sectors, the cache victim takes its place
+            info victim = cache_replace(c, addr, (write && write_back(c)) ? byte_mask(c, addr, size) : 0, sim_stats);
+            block *b = &c->sets[victim.index][victim.set];
+            b->sectors |= entry.sectors;
+            b->dirty_bytes |= entry.dirty_bytes;
+            b->dirty = b->dirty_bytes != 0;
+            cache_evict(c, victim, addr, filled, sim_stats);
+            hit = true;
+        }
+        if (write && c->wbuf.entries && (!write_back(c) || (around && !hit))) {
+            //the store leaves the cache through the write buffer, a fill still goes on down
+            latency += buffer_store(core, c, addr, size, sim_stats);
+            write = false;
+            if (hit || around) {
+                found = hit ? (int64_t)k : found;
+                break;
             }
         }
-        else {
-            //L2 MISS
-            //fetch data from main memory
-            mem_access(sim_stats);
-            //load to L2
-            l2_victim1 = l2_replace(addr, type, sim_stats, false);
-            //if there is dirty victim from L2
-            if (l2_victim1.eviction && l2_victim1.dirty) {
-                //write back
-                sim_stats->l2unified_num_write_backs++;
-                mem_access(sim_stats);
-            }
-            //load to L1
-            l1_victim = l1_replace(addr, type, sim_stats);
-            //if there is dirty victim from L1
-            if (l1_victim.eviction && l1_victim.dirty) {
-                //save dirty victim in L2
-                //make sure not to evict just added block
-                
-                if (rp == LFU) {
-                    //for LFU
-                    //set MRU history to MAX to prevent eviction
-                    //special thanks to TAs 
-                    uint64_t MRU_index = find_index_l2(addr);
-                    uint64_t MRU_tag = find_tag_l2(addr);
-                    uint64_t MRU_way;
-                    for (uint64_t i = 0; i < wayNum_l2;i++) {
-                        if (l2_cache[MRU_index][i].tag == MRU_tag)
-                            MRU_way = i;
-                    }
-                    tmp = l2_cache[MRU_index][MRU_way].history;
-                    l2_cache[MRU_index][MRU_way].history = MAX;
-                    l2_victim2 = l2_replace(l1_victim.addr, type, sim_stats, true);
-                    l2_cache[MRU_index][MRU_way].history = tmp;
+        if (hit) {
+            //HIT
+            if (found < 0) {
+                found = k;
+            }
+            if (!(write && !write_back(c))) {
+                write = false;
+                break;
+            }
+            //write through, the store goes on down
+            continue;
+        }
+        //MISS
+        //an exclusive level only receives victims of the level above
+        if (found < 0 && !around && (k == 0 || c->inclusion != EXCLUSIVE)) {
+            fetch = true;
+            if (c->dbp != NULL && dbp_dead(c, addr) && !dbp_sampled(c, addr)) {
+                //a block predicted dead skips the cache, a store goes on down
+                sim_stats->caches[c->id].num_bypasses++;
+                continue;
+            }
+            alloc[k] = true;
+            if (write && write_back(c)) {
+                //the store stops here once the block is loaded
+                dirty[k] = byte_mask(c, addr, size);
+                write = false;
+            }
+        }
+    }
+
+    if (dir != NULL && !requested && type == 'S') {
+        //a store that hit in the private levels still needs every other copy gone
+        coherence_request(core, addr, true, filled, sim_stats);
+    }
+    cache *last = hierarchy[core][num_levels - 1][side];
+    if (found < 0 && fetch) {
+        //MISS IN EVERY LEVEL
+        //fetch data from main memory
+        latency += (double)mem_access(addr, false, side, (uint64_t)1 << last->sectorBit, sim_stats);
+    }
+    if (write) {
+        //just write through, only the bytes of the store
+        mem_access(addr, true, side, size ? size : (uint64_t)1 << last->sectorBit, sim_stats);
+    }
+    //load to the levels that missed
+    fill_up(core, addr, side, found < 0 ? num_levels : (uint64_t)found, alloc, dirty, filled, NULL, 0, sim_stats);
+    if (dir != NULL) {
+        coherence_track(core, addr);
+    }
+
+    //train the prefetchers once the demand access is done
+    for (k = from; k < num_levels; k++) {
+        if (hierarchy[core][k][side]->pf && trigger[k]) {
+            issue_prefetches(hierarchy[core][k][side], addr, sim_stats);
+        }
+    }
+    fill_type = type_before;
+    fill_core = core_before;
+    return latency;
+}
+
+/**
+ * Function to translate a virtual address through a core's TLBs. A miss in
+ * every TLB walks the page table, loading each PTE through the data caches
+ * Returns the cycles the translation took
+ *
+ */
+double translate(uint64_t core, uint64_t *addr, int side, struct sim_stats_t *sim_stats)
+{
+    uint64_t page_bits = PAGE_BITS[vm.page];
+    uint64_t vpn = *addr >> page_bits;
+    struct tlb_stats_t *first = side == 0 ? &sim_stats->itlb : &sim_stats->dtlb;
+    double latency = side == 0 ? vm.itlb.hit_time : vm.dtlb.hit_time;
+    first->num_accesses++;
+    if (!tlb_lookup(tlbs[core][side], vpn)) {
+        first->num_misses++;
+        bool hit = false;
+        if (tlbs[core][2] != NULL) {
+            sim_stats->stlb.num_accesses++;
+            latency += vm.stlb.hit_time;
+            hit = tlb_lookup(tlbs[core][2], vpn);
+            if (!hit) {
+                sim_stats->stlb.num_misses++;
+            }
+        }
+        if (!hit) {
+            //PAGE WALK
+            uint64_t ptes[MAX_WALK_LEVELS];
+            uint64_t n = page_table_walk(pt, vpn, ptes);
+            double walk = 0;
+            for (uint64_t i = 0; i < n; i++) {
+                walk += hierarchy_access(core, 0, ptes[i], LOAD, 0, sim_stats);
+            }
+            sim_stats->num_page_walks++;
+            sim_stats->num_walk_accesses += n;
+            sim_stats->walk_cycles += (uint64_t)(walk + 0.5);
+            latency += walk;
+            if (tlbs[core][2] != NULL) {
+                tlb_insert(tlbs[core][2], vpn);
+            }
+        }
+        tlb_insert(tlbs[core][side], vpn);
+    }
+    *addr = (page_table_frame(pt, vpn) << page_bits) | (*addr & (((uint64_t)1 << page_bits) - 1));
+    return latency;
+}
+
+/**
+ * Helper functions for the latency histograms, log-linear like an HDR histogram:
+ * a bucket holds the values with the same top LATENCY_SUB_BITS significant bits
+ *
+ */
+void latency_record(struct latency_histogram_t *h, uint64_t value) {
+    uint64_t bucket = value;
+    if (value >> LATENCY_SUB_BITS) {
+        uint64_t shift = 63 - __builtin_clzll(value) - LATENCY_SUB_BITS;
+        bucket = ((shift + 1) << LATENCY_SUB_BITS) + (value >> shift) - ((uint64_t)1 << LATENCY_SUB_BITS);
+    }
+    h->counts[bucket]++;
+    h->total++;
+}
+uint64_t latency_percentile(const struct latency_histogram_t *h, double percent) {
+    uint64_t rank = (uint64_t)ceil(percent / 100.0 * (double)h->total);
+    uint64_t seen = 0;
+    rank = rank ? rank : 1;
+    for (uint64_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        seen += h->counts[bucket];
+        if (seen >= rank) {
+            //the highest latency the bucket stands for
+            if (bucket < ((uint64_t)1 << LATENCY_SUB_BITS)) {
+                return bucket;
+            }
+            uint64_t shift = (bucket >> LATENCY_SUB_BITS) - 1;
+            uint64_t top = (bucket & (((uint64_t)1 << LATENCY_SUB_BITS) - 1)) + ((uint64_t)1 << LATENCY_SUB_BITS);
+            return ((top + 1) << shift) - 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Function to perform an access of one core, translating its address first
+ * with virtual memory. An access crossing a first level block is split into
+ * one lookup per block, done one after the other
+ * Returns the latency of the access in cycles
+ *
+ * @param core The core issuing the access
+ * @param addr The address being accessed by the processor
+ * @param type The type of access - Load (L), Store (S) or Instruction (I)
+ * @param size Bytes accessed, 0 if the trace does not say
+ * @param sim_stats Pointer to simulation statistics structure - Should be populated here
+ * @param sim_conf Pointer to the simulation configuration structure - Don't modify it in this function
+ */
+uint64_t core_access(uint64_t core, uint64_t addr, char type, uint64_t size, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
+{
+    int side = type == INST ? 0 : 1;
+    uint64_t block_size = (uint64_t)1 << hierarchy[core][0][side]->offsetBit;
+    uint64_t end = addr + size;
+    uint64_t pieces = 0;
+    double latency = 0;
+
+    //advance the core's clock to the arrival of this access
+    core_cycle[core] += issue_interval;
+    cycle = core_cycle[core];
+    sim_stats->cores[core].num_accesses++;
+    if (size) {
+        sim_stats->num_sized_accesses++;
+    }
+
+    do {
+        uint64_t next = (addr | (block_size - 1)) + 1;
+        uint64_t piece = size ? (end < next ? end : next) - addr : 0;
+        uint64_t paddr = addr;
+        if (pt != NULL) {
+            latency += translate(core, &paddr, side, sim_stats);
+        }
+        latency += hierarchy_access(core, 0, paddr, type, piece, sim_stats);
+        addr += piece;
+        pieces++;
+    } while (addr < end);
+    if (pieces > 1) {
+        sim_stats->num_split_accesses++;
+    }
+
+    core_cycle[core] = cycle;
+    if (latency_histogram) {
+        latency_record(&sim_stats->latency[access_class(type)], (uint64_t)(latency + 0.5));
+    }
+    if (series != NULL) {
+        timeseries_access(series, cycle, latency, sim_stats);
+    }
+    access_seq++;
+    return (uint64_t)(latency + 0.5);
+}
+
+/**
+ * Function to look up the hit time of a cache in its level's access time table
+ * Returns the hit time in cycles
+ *
+ */
+double level_hit_time(const struct level_config_t *level, const struct cache_config_t *cache)
+{
+    if (level->hit_time > 0) {
+        return level->hit_time;
+    }
+    if (cache->s > MAX_S) {
+        return level->access_time[MAX_S + 1][cache->c - level->min_c];
+    }
+    return level->access_time[cache->s][cache->c - level->min_c];
+}
+
+/**
+ * Helper to compute the average access time of every cache, from the last level up
+ * Returns the overall average access time. With without_prefetch set nothing is
+ * stored, every useful prefetch counts as the demand miss it would have been and
+ * every polluting miss as a hit
+ *
+ */
+double compute_aat(struct sim_stats_t *sim_stats, double mem_penalty, bool without_prefetch) {
+    double AAT[MAX_CACHES];
+    bool done[MAX_CACHES] = {false};
+    for (uint64_t core = 0; core < num_cores; core++) {
+        for (int64_t k = (int64_t)num_levels - 1; k >= 0; k--) {
+            for (int side = 0; side < 2; side++) {
+                cache *c = hierarchy[core][k][side];
+                if (done[c->id]) {
+                    //the other side of a unified level, or shared with a core already done
+                    continue;
                 }
-                else {
-                    l2_victim2 = l2_replace(l1_victim.addr, type, sim_stats, true);
+                done[c->id] = true;
+                struct cache_stats_t *stats = &sim_stats->caches[c->id];
+                double miss_penalty = (k + 1 == (int64_t)num_levels) ? mem_penalty : AAT[hierarchy[core][k + 1][side]->id];
+                if (c->vc.entries) {
+                    //a victim cache sits below the cache and is probed on every miss
+                    miss_penalty = stats->victim.hit_time + stats->victim.miss_rate * miss_penalty;
+                }
+                double miss_rate = stats->miss_rate;
+                if (without_prefetch) {
+                    miss_rate = stats->num_accesses ? (double)(stats->num_misses + stats->prefetch.num_useful - stats->prefetch.num_polluting) / (double)stats->num_accesses : 0;
                 }
-                
-                //l2_victim2 = l2_replace(l1_victim.addr, type, sim_stats, true, true);
-                //if there is dirty victim from L2
-                if (l2_victim2.eviction && l2_victim2.dirty) {
-                    //write back
-                    sim_stats->l2unified_num_write_backs++;
-                    mem_access(sim_stats);
+                AAT[c->id] = stats->hit_time + miss_rate * miss_penalty;
+                if (!without_prefetch) {
+                    stats->miss_penalty = miss_penalty;
+                    stats->AAT = AAT[c->id];
                 }
             }
         }
     }
+
+    //weight the cores by the accesses they issued
+    double inst_total = 0, data_total = 0;
+    uint64_t inst_accesses = 0, data_accesses = 0;
+    for (uint64_t core = 0; core < num_cores; core++) {
+        struct cache_stats_t *inst = &sim_stats->caches[hierarchy[core][0][0]->id];
+        struct cache_stats_t *data = &sim_stats->caches[hierarchy[core][0][1]->id];
+        double inst_AAT = AAT[inst - sim_stats->caches];
+        double data_AAT = AAT[data - sim_stats->caches];
+        if (!without_prefetch) {
+            sim_stats->cores[core].inst_avg_access_time = inst_AAT;
+            sim_stats->cores[core].data_avg_access_time = data_AAT;
+            sim_stats->cores[core].avg_access_time = (inst_AAT * inst->num_accesses + data_AAT * data->num_accesses) / (data->num_accesses + inst->num_accesses);
+        }
+        if (num_cores == 1) {
+            if (!without_prefetch) {
+                sim_stats->inst_avg_access_time = inst_AAT;
+                sim_stats->data_avg_access_time = data_AAT;
+            }
+            return (inst_AAT * inst->num_accesses + data_AAT * data->num_accesses) / (data->num_accesses + inst->num_accesses);
+        }
+        inst_total += inst_AAT * inst->num_accesses_insts;
+        inst_accesses += inst->num_accesses_insts;
+        data_total += data_AAT * (data->num_accesses_loads + data->num_accesses_stores);
+        data_accesses += data->num_accesses_loads + data->num_accesses_stores;
+    }
+    if (!without_prefetch) {
+        sim_stats->inst_avg_access_time = inst_accesses ? inst_total / (double)inst_accesses : 0;
+        sim_stats->data_avg_access_time = data_accesses ? data_total / (double)data_accesses : 0;
+    }
+    return (inst_total + data_total) / (double)(inst_accesses + data_accesses);
+}
+
+/**
+ * Helper to add the translation overhead to the average access times: the
+ * first level TLB, its misses going to the L2 TLB and the misses of every TLB
+ * paying the average walk
+ *
+ */
+void translation_time(struct sim_stats_t *sim_stats) {
+    struct tlb_stats_t *tlb_stats[] = {&sim_stats->itlb, &sim_stats->dtlb, &sim_stats->stlb};
+    const struct tlb_config_t *confs[] = {&vm.itlb, &vm.dtlb, &vm.stlb};
+    for (int i = 0; i < 3; i++) {
+        tlb_stats[i]->hit_time = confs[i]->hit_time;
+        tlb_stats[i]->miss_rate = tlb_stats[i]->num_accesses ? (double)tlb_stats[i]->num_misses / (double)tlb_stats[i]->num_accesses : 0;
+    }
+    if (sim_stats->num_page_walks) {
+        sim_stats->avg_walk_time = (double)sim_stats->walk_cycles / (double)sim_stats->num_page_walks;
+    }
+    double miss_penalty = sim_stats->avg_walk_time;
+    if (vm.stlb.entries) {
+        miss_penalty = sim_stats->stlb.hit_time + sim_stats->stlb.miss_rate * miss_penalty;
+    }
+    double inst = sim_stats->itlb.hit_time + sim_stats->itlb.miss_rate * miss_penalty;
+    double data = sim_stats->dtlb.hit_time + sim_stats->dtlb.miss_rate * miss_penalty;
+    uint64_t insts = sim_stats->itlb.num_accesses;
+    uint64_t datas = sim_stats->dtlb.num_accesses;
+    sim_stats->inst_translation_time = inst;
+    sim_stats->data_translation_time = data;
+    sim_stats->inst_avg_access_time += inst;
+    sim_stats->data_avg_access_time += data;
+    sim_stats->avg_access_time += (inst * insts + data * datas) / (double)(insts + datas);
+    for (uint64_t core = 0; core < num_cores; core++) {
+        sim_stats->cores[core].inst_avg_access_time += inst;
+        sim_stats->cores[core].data_avg_access_time += data;
+        sim_stats->cores[core].avg_access_time += (inst * insts + data * datas) / (double)(insts + datas);
+    }
+}
+
+/**
+ * Helper to check if a level below a cache still holds a block
+ *
+ */
+bool held_below(cache *c, uint64_t addr) {
+    uint64_t way;
+    for (uint64_t k = c->level + 1; k < num_levels; k++) {
+        cache *lower = hierarchy[c->core][k][c->side];
+        if (cache_find(lower, addr, &way) != NULL || vc_find(lower, addr) != NULL)
+            return true;
+    }
+    return false;
 }
 
 /**
@@ -698,48 +1950,542 @@ void cache_access(uint64_t addr, char type, struct sim_stats_t *sim_stats, struc
  */
 void sim_cleanup(struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
 {
-    // TODO
-    if (sim_conf->l1inst.s > MAX_S) {
-        sim_stats->l1inst_hit_time = (double)L1_ACCESS_TIME[4][sim_conf->l1inst.c - 9];
+    bool prefetching = false;
+    bool inclusion = false;
+    //stores still waiting in a write buffer are written before the statistics are taken
+    for (uint64_t i = 0; i < num_caches; i++) {
+        while (caches[i].wbuf.used) {
+            buffer_drain(caches[i].core, &caches[i], sim_stats);
+        }
     }
-    else {
-        sim_stats->l1inst_hit_time = (double)L1_ACCESS_TIME[sim_conf->l1inst.s][sim_conf->l1inst.c - 9];
+    if (series != NULL) {
+        uint64_t end = 0;
+        for (uint64_t core = 0; core < num_cores; core++) {
+            end = core_cycle[core] > end ? core_cycle[core] : end;
+        }
+        timeseries_close(series, end, sim_stats);
     }
-    if (sim_conf->l1data.s > MAX_S) {
-        sim_stats->l1data_hit_time = (double)L1_ACCESS_TIME[4][sim_conf->l1data.c - 9];
+    event_log_close(event_log);
+    for (uint64_t i = 0; i < num_caches; i++) {
+        cache *c = &caches[i];
+        struct cache_stats_t *stats = &sim_stats->caches[i];
+        stats->hit_time = level_hit_time(&sim_conf->levels[c->level], c->conf);
+        if (c->way_pred != NULL) {
+            //every access but a correctly predicted hit pays for the second probe
+            uint64_t hits = stats->num_way_hits + stats->num_way_mispredictions;
+            double slow = stats->num_accesses ? (double)(stats->num_accesses - stats->num_way_hits) / (double)stats->num_accesses : 0;
+            stats->way_prediction_accuracy = hits ? (double)stats->num_way_hits / (double)hits : 0;
+            stats->hit_time = c->fast_hit + slow * (double)c->conf->mispredict_penalty;
+        }
+        stats->miss_rate = stats->num_accesses ? (double)stats->num_misses / (double)stats->num_accesses : 0;
+        if (c->vc.entries) {
+            stats->victim.hit_time = (double)c->conf->vc_hit_time;
+            if (stats->victim.num_accesses) {
+                stats->victim.miss_rate = 1.0 - (double)stats->victim.num_hits / (double)stats->victim.num_accesses;
+            }
+        }
+        if (c->partitioned) {
+            //the share of the valid blocks filled for each class and core
+            uint64_t blocks = 0;
+            for (uint64_t j = 0; j < c->indexNum; j++) {
+                for (uint64_t w = 0; w < c->wayNum; w++) {
+                    if (c->sets[j][w].valid) {
+                        blocks++;
+                        stats->class_occupancy[c->sets[j][w].cls]++;
+                        stats->core_occupancy[c->sets[j][w].owner]++;
+                    }
+                }
+            }
+            for (uint64_t j = 0; j < 3 && blocks; j++) {
+                stats->class_occupancy[j] /= (double)blocks;
+            }
+            for (uint64_t j = 0; j < num_cores && blocks; j++) {
+                stats->core_occupancy[j] /= (double)blocks;
+            }
+        }
+        if (c->banks != NULL) {
+            //a demand access waits for its bank as long as the average bank access
+            uint64_t accesses = 0;
+            uint64_t end = 0;
+            for (uint64_t core = 0; core < num_cores; core++) {
+                end = core_cycle[core] > end ? core_cycle[core] : end;
+            }
+            for (uint64_t j = 0; j < c->conf->banks; j++) {
+                accesses += stats->bank_accesses[j];
+                end = c->banks[j].ready > end ? c->banks[j].ready : end;
+            }
+            for (uint64_t j = 0; j < c->conf->banks && end; j++) {
+                stats->bank_utilization[j] = (double)stats->bank_busy_cycles[j] / (double)end;
+            }
+            if (accesses) {
+                stats->hit_time += (double)stats->num_bank_conflict_cycles / (double)accesses;
+            }
+        }
+        if (stats->num_predictions_checked) {
+            stats->predictor_accuracy = (double)stats->num_predictions_correct / (double)stats->num_predictions_checked;
+        }
+        if (stats->num_bit_slice_misses) {
+            stats->conflict_miss_reduction = 1.0 - (double)stats->num_misses / (double)stats->num_bit_slice_misses;
+        }
+        if (stats->write_buffer.num_writes) {
+            stats->write_buffer.merge_rate = (double)stats->write_buffer.num_merges / (double)stats->write_buffer.num_writes;
+            stats->write_buffer.traffic_reduction = 1.0 - (double)stats->write_buffer.num_bytes_drained / (double)stats->write_buffer.num_bytes_written;
+        }
+        prefetching = prefetching || c->pf != NULL;
+        inclusion = inclusion || c->inclusion != NINE;
     }
-    else {
-        sim_stats->l1data_hit_time = (double)L1_ACCESS_TIME[sim_conf->l1data.s][sim_conf->l1data.c - 9];
+
+    double mem_penalty = MEM_ACCESS_TIME;
+    if (mem_model == MEM_DRAM) {
+        //the miss penalty is the average latency the DRAM model produced
+        dram_cleanup(sim_stats);
+        mem_penalty = sim_stats->mem_avg_read_latency;
     }
-    if (sim_conf->l2unified.s > MAX_S) {
-        sim_stats->l2unified_hit_time = (double)L2_ACCESS_TIME[4][sim_conf->l2unified.c - 17];
+    sim_stats->avg_access_time = compute_aat(sim_stats, mem_penalty, false);
+    if (prefetching) {
+        //estimate the AAT without prefetching
+        sim_stats->prefetch_AAT_change = sim_stats->avg_access_time - compute_aat(sim_stats, mem_penalty, true);
     }
-    else {
-        sim_stats->l2unified_hit_time = (double)L2_ACCESS_TIME[sim_conf->l2unified.s][sim_conf->l2unified.c - 17];
-    }
-
-    sim_stats->l1inst_miss_rate = (double)sim_stats->l1inst_num_misses / (double)sim_stats->l1inst_num_accesses;
-    sim_stats->l1data_miss_rate = (double)sim_stats->l1data_num_misses / (double)sim_stats->l1data_num_accesses;
-    sim_stats->l2unified_miss_rate = (double)sim_stats->l2unified_num_misses / (double)sim_stats->l2unified_num_accesses;
-    sim_stats->l2unified_miss_penalty = 80.0;
-    
-
-    sim_stats->l2unified_AAT = sim_stats->l2unified_hit_time + sim_stats->l2unified_miss_rate * sim_stats->l2unified_miss_penalty;
-    sim_stats->l1inst_miss_penalty = sim_stats->l2unified_AAT;
-    sim_stats->l1data_miss_penalty = sim_stats->l1inst_miss_penalty;
-    sim_stats->l1inst_AAT = sim_stats->l1inst_hit_time + sim_stats->l1inst_miss_rate * sim_stats->l2unified_AAT;
-    sim_stats->l1data_AAT = sim_stats->l1data_hit_time + sim_stats->l1data_miss_rate * sim_stats->l2unified_AAT;
-    sim_stats->inst_avg_access_time = sim_stats->l1inst_AAT;
-    sim_stats->data_avg_access_time = sim_stats->l1data_AAT;
-    sim_stats->avg_access_time = (sim_stats->l1inst_AAT * sim_stats->l1inst_num_accesses + sim_stats->l1data_AAT * sim_stats->l1data_num_accesses) / (sim_stats->l1data_num_accesses + sim_stats->l1inst_num_accesses);
+    if (pt != NULL) {
+        translation_time(sim_stats);
+    }
+    if (latency_histogram) {
+        const double percents[] = {50, 90, 99, 99.9};
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                sim_stats->latency[i].percentiles[j] = latency_percentile(&sim_stats->latency[i], percents[j]);
+            }
+        }
+    }
+
+    if (inclusion) {
+        //count every distinct block the hierarchy holds, copies in several levels only once
+        uint64_t capacity = 0;
+        for (uint64_t i = 0; i < num_caches; i++) {
+            cache *c = &caches[i];
+            if (c->level + 1 == num_levels) {
+                capacity += (c->indexNum * c->wayNum) << c->offsetBit;
+            }
+            for (uint64_t j = 0; j < c->indexNum; j++) {
+                for (uint64_t w = 0; w < c->wayNum; w++) {
+                    if (c->sets[j][w].valid && !held_below(c, restore_addr(c, c->sets[j][w].tag, j, w)))
+                        sim_stats->effective_capacity += sector_bytes(c->sets[j][w].sectors, c->sectorBit);
+                }
+            }
+            for (uint64_t j = 0; j < c->vc.entries; j++) {
+                if (c->vc.blocks[j].valid && !held_below(c, c->vc.blocks[j].tag << c->offsetBit))
+                    sim_stats->effective_capacity += sector_bytes(c->vc.blocks[j].sectors, c->sectorBit);
+            }
+        }
+        sim_stats->effective_capacity_gain = (double)sim_stats->effective_capacity / (double)capacity;
+    }
+
+    if (analysis_conf.file[0]) {
+        //write the distributions of every cache in the order of the statistics
+        FILE *out = fopen(analysis_conf.file, analysis_conf.format == OUTPUT_BINARY ? "wb" : "w");
+        if (out == NULL) {
+            print_error_exit("Could not open the analysis file\n");
+        }
+        analysis_header(out, analysis_conf.format);
+        for (uint64_t i = 0; i < num_caches; i++) {
+            analysis_write(out, analysis_conf.format, sim_stats->caches[i].name, caches[i].an, analysis_conf.top_misses);
+        }
+        fclose(out);
+    }
+
     //free memory
-    for (uint64_t i = 0; i < indexNum_l1_data; i++)
-        free(l1_data_cache[i]);
-    free(l1_data_cache);
-    for (uint64_t i = 0; i < indexNum_l1_inst; i++)
-        free(l1_inst_cache[i]);
-    free(l1_inst_cache);
-    for (uint64_t i = 0; i < indexNum_l2; i++)
-        free(l2_cache[i]);
-    free(l2_cache);
+    for (uint64_t i = 0; i < num_caches; i++) {
+        for (uint64_t j = 0; j < caches[i].indexNum; j++)
+            free(caches[i].sets[j]);
+        free(caches[i].sets);
+        free(caches[i].vc.blocks);
+        free(caches[i].shadow);
+        free(caches[i].dbp);
+        free(caches[i].way_pred);
+        for (uint64_t j = 0; caches[i].banks != NULL && j < caches[i].conf->banks; j++) {
+            free(caches[i].banks[j].queue);
+        }
+        free(caches[i].banks);
+        free(caches[i].wbuf.slots);
+        prefetch_destroy(caches[i].pf);
+        classifier_destroy(caches[i].classifier);
+        analysis_destroy(caches[i].an);
+    }
+    if (dir != NULL) {
+        directory_destroy(dir);
+    }
+    if (pt != NULL) {
+        for (uint64_t core = 0; core < num_cores; core++) {
+            for (int i = 0; i < 3; i++)
+                tlb_destroy(tlbs[core][i]);
+        }
+        page_table_destroy(pt);
+    }
+}
+
+// Helper to add the counters of one statistic array to another
+void add_counts(uint64_t *into, const uint64_t *from, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        into[i] += from[i];
+    }
+}
+
+/**
+ * Function to add the statistics of a segment of the run to the statistics of the run
+ * The counters add up and sim_cleanup derives the rates and times from them
+ * afterwards. What describes the caches at the end is taken from the last
+ * segment, the bank utilizations are averaged over the segments
+ *
+ * @param into Statistics of the run, only names and hit times before the first segment
+ * @param from Statistics of the segment, after its sim_cleanup
+ * @param segments Number of segments of the run
+ * @param last True for the segment that ends the run
+ */
+void sim_stats_merge(struct sim_stats_t *into, const struct sim_stats_t *from, uint64_t segments, bool last)
+{
+    for (uint64_t i = 0; i < num_caches; i++) {
+        struct cache_stats_t *a = &into->caches[i];
+        const struct cache_stats_t *b = &from->caches[i];
+        a->num_accesses += b->num_accesses;
+        a->num_accesses_insts += b->num_accesses_insts;
+        a->num_accesses_loads += b->num_accesses_loads;
+        a->num_accesses_stores += b->num_accesses_stores;
+        a->num_misses += b->num_misses;
+        a->num_misses_insts += b->num_misses_insts;
+        a->num_misses_loads += b->num_misses_loads;
+        a->num_misses_stores += b->num_misses_stores;
+        a->num_sector_misses += b->num_sector_misses;
+        a->num_bit_slice_misses += b->num_bit_slice_misses;
+        add_counts(&a->num_class_misses[0][0], &b->num_class_misses[0][0], 9);
+        a->num_evictions += b->num_evictions;
+        a->num_write_backs += b->num_write_backs;
+        a->num_bytes_transferred += b->num_bytes_transferred;
+        a->num_back_invalidations += b->num_back_invalidations;
+        a->num_back_invalidation_write_backs += b->num_back_invalidation_write_backs;
+        a->num_way_hits += b->num_way_hits;
+        a->num_way_mispredictions += b->num_way_mispredictions;
+        a->num_bank_conflicts += b->num_bank_conflicts;
+        a->num_bank_conflict_cycles += b->num_bank_conflict_cycles;
+        a->num_bank_queue_stalls += b->num_bank_queue_stalls;
+        add_counts(a->bank_accesses, b->bank_accesses, MAX_BANKS);
+        add_counts(a->bank_busy_cycles, b->bank_busy_cycles, MAX_BANKS);
+        for (uint64_t j = 0; j < MAX_BANKS; j++) {
+            a->bank_utilization[j] += b->bank_utilization[j] / (double)segments;
+        }
+        a->num_bypasses += b->num_bypasses;
+        a->num_dead_evictions += b->num_dead_evictions;
+        a->num_predictions_checked += b->num_predictions_checked;
+        a->num_predictions_correct += b->num_predictions_correct;
+        add_counts(a->num_core_misses, b->num_core_misses, MAX_CORES);
+        if (last) {
+            memcpy(a->class_occupancy, b->class_occupancy, sizeof(a->class_occupancy));
+            memcpy(a->core_occupancy, b->core_occupancy, sizeof(a->core_occupancy));
+        }
+        a->victim.num_accesses += b->victim.num_accesses;
+        a->victim.num_hits += b->victim.num_hits;
+        a->victim.num_evictions += b->victim.num_evictions;
+        a->victim.num_write_backs += b->victim.num_write_backs;
+        a->write_buffer.num_writes += b->write_buffer.num_writes;
+        a->write_buffer.num_merges += b->write_buffer.num_merges;
+        a->write_buffer.num_full_stalls += b->write_buffer.num_full_stalls;
+        a->write_buffer.num_stall_cycles += b->write_buffer.num_stall_cycles;
+        a->write_buffer.num_drains += b->write_buffer.num_drains;
+        a->write_buffer.num_bytes_written += b->write_buffer.num_bytes_written;
+        a->write_buffer.num_bytes_drained += b->write_buffer.num_bytes_drained;
+        a->prefetch.num_issued += b->prefetch.num_issued;
+        a->prefetch.num_useful += b->prefetch.num_useful;
+        a->prefetch.num_late += b->prefetch.num_late;
+        a->prefetch.num_polluting += b->prefetch.num_polluting;
+    }
+    for (uint64_t core = 0; core < num_cores; core++) {
+        into->cores[core].num_accesses += from->cores[core].num_accesses;
+        into->cores[core].num_invalidations += from->cores[core].num_invalidations;
+        into->cores[core].num_upgrades += from->cores[core].num_upgrades;
+        into->cores[core].num_c2c_transfers += from->cores[core].num_c2c_transfers;
+    }
+    into->num_sized_accesses += from->num_sized_accesses;
+    into->num_split_accesses += from->num_split_accesses;
+    struct tlb_stats_t *tlbs_into[] = {&into->itlb, &into->dtlb, &into->stlb};
+    const struct tlb_stats_t *tlbs_from[] = {&from->itlb, &from->dtlb, &from->stlb};
+    for (int i = 0; i < 3; i++) {
+        tlbs_into[i]->num_accesses += tlbs_from[i]->num_accesses;
+        tlbs_into[i]->num_misses += tlbs_from[i]->num_misses;
+    }
+    into->num_page_walks += from->num_page_walks;
+    into->num_walk_accesses += from->num_walk_accesses;
+    into->walk_cycles += from->walk_cycles;
+    if (last) {
+        into->effective_capacity = from->effective_capacity;
+    }
+    into->mem_num_reads += from->mem_num_reads;
+    into->mem_num_writes += from->mem_num_writes;
+    into->mem_num_row_hits += from->mem_num_row_hits;
+    into->mem_num_row_misses += from->mem_num_row_misses;
+    into->mem_num_row_conflicts += from->mem_num_row_conflicts;
+    into->mem_num_queue_stalls += from->mem_num_queue_stalls;
+    into->mem_read_cycles += from->mem_read_cycles;
+    into->mem_queue_cycles += from->mem_queue_cycles;
+    for (int i = 0; i < 3; i++) {
+        add_counts(into->latency[i].counts, from->latency[i].counts, LATENCY_BUCKETS);
+        into->latency[i].total += from->latency[i].total;
+    }
+}
+
+// Helpers to write and read a checkpoint, a short read means the file is cut off
+// (empty tables are passed as NULL with no bytes, which the stdio calls do not take)
+void checkpoint_put(FILE *f, const void *p, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    fwrite(p, 1, n, f);
+}
+void checkpoint_get(FILE *f, void *p, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (fread(p, 1, n, f) != n) {
+        print_error_exit("Checkpoint file is truncated\n");
+    }
+}
+uint64_t checkpoint_get_u64(FILE *f) {
+    uint64_t v;
+    checkpoint_get(f, &v, sizeof(v));
+    return v;
+}
+
+/**
+ * Function to list what a cache's checkpoint depends on, a restore needs the same values
+ *
+ */
+void checkpoint_shape(cache *c, uint64_t *shape) {
+    shape[0] = c->indexNum;
+    shape[1] = c->wayNum;
+    shape[2] = c->offsetBit;
+    shape[3] = c->sectorNum;
+    shape[4] = c->rp;
+    shape[5] = c->wp;
+    shape[6] = c->inclusion;
+    shape[7] = c->indexing;
+    shape[8] = c->insertion;
+    shape[9] = c->vc.entries;
+    shape[10] = c->wbuf.entries;
+    shape[11] = c->banks != NULL ? c->conf->banks : 0;
+    shape[12] = c->banks != NULL ? c->conf->bank_queue : 0;
+    shape[13] = c->dbp != NULL;
+    shape[14] = c->way_pred == NULL ? 0 : c->conf->way_pred == WAY_PREDICT_MRU ? c->indexNum : (uint64_t)1 << WAY_TABLE_BITS;
+    shape[15] = c->pf != NULL ? c->conf->pf : NO_PREFETCH;
+    shape[16] = c->classifier != NULL;
+}
+
+/**
+ * Function to write the valid blocks of an array, each with its position in the array
+ * rows is NULL for a flat array of n blocks, otherwise the sets of c
+ *
+ */
+void checkpoint_put_blocks(FILE *f, cache *c, block **rows, block *flat, uint64_t n) {
+    uint64_t valid = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        valid += (rows != NULL ? rows[i / c->wayNum][i % c->wayNum] : flat[i]).valid;
+    }
+    checkpoint_put(f, &valid, sizeof(valid));
+    for (uint64_t i = 0; i < n; i++) {
+        const block *b = rows != NULL ? &rows[i / c->wayNum][i % c->wayNum] : &flat[i];
+        if (!b->valid) {
+            continue;
+        }
+        uint8_t flags[4] = {(uint8_t)(b->dirty | b->prefetched << 1 | b->reused << 2 | b->predicted_dead << 3), b->cls, b->owner, 0};
+        uint64_t fields[5] = {b->tag, b->history, b->sectors, b->dirty_bytes, b->ready};
+        uint32_t pos = (uint32_t)i;
+        checkpoint_put(f, &pos, sizeof(pos));
+        checkpoint_put(f, flags, sizeof(flags));
+        checkpoint_put(f, fields, sizeof(fields));
+    }
+}
+
+void checkpoint_get_blocks(FILE *f, cache *c, block **rows, block *flat, uint64_t n) {
+    uint64_t valid = checkpoint_get_u64(f);
+    for (uint64_t k = 0; k < valid; k++) {
+        uint32_t pos;
+        uint8_t flags[4];
+        uint64_t fields[5];
+        checkpoint_get(f, &pos, sizeof(pos));
+        checkpoint_get(f, flags, sizeof(flags));
+        checkpoint_get(f, fields, sizeof(fields));
+        if (pos >= n) {
+            print_error_exit("Checkpoint has a block outside its cache\n");
+        }
+        block *b = rows != NULL ? &rows[pos / c->wayNum][pos % c->wayNum] : &flat[pos];
+        b->valid = true;
+        b->dirty = flags[0] & 1;
+        b->prefetched = (flags[0] >> 1) & 1;
+        b->reused = (flags[0] >> 2) & 1;
+        b->predicted_dead = (flags[0] >> 3) & 1;
+        b->cls = flags[1];
+        b->owner = flags[2];
+        b->tag = fields[0];
+        b->history = fields[1];
+        b->sectors = fields[2];
+        b->dirty_bytes = fields[3];
+        b->ready = fields[4];
+    }
+}
+
+/**
+ * Function to save the state of the hierarchy after the accesses simulated so far
+ * The file starts with the magic "CSCP" and a uint32 version. It holds the clocks,
+ * the driver's positions in the traces and per cache its shape, valid blocks, victim
+ * cache, write buffer, banks, predictor and prefetcher tables and miss classifier,
+ * then the DRAM banks, buses and queues. TLBs are not saved, so Virtual Memory
+ * can not be combined with a checkpoint
+ *
+ * @param file Checkpoint file
+ * @param positions Where the driver continues from, like the offset of every trace
+ * @param num_positions Number of positions
+ */
+void checkpoint_save(const char *file, const uint64_t *positions, uint64_t num_positions)
+{
+    FILE *f = fopen(file, "wb");
+    if (f == NULL) {
+        print_error_exit("Could not open the checkpoint file\n");
+    }
+    uint32_t version = CHECKPOINT_VERSION;
+    checkpoint_put(f, "CSCP", 4);
+    checkpoint_put(f, &version, sizeof(version));
+    uint64_t clocks[5] = {num_caches, num_cores, count, cycle, access_seq};
+    checkpoint_put(f, clocks, sizeof(clocks));
+    checkpoint_put(f, core_cycle, num_cores * sizeof(uint64_t));
+    checkpoint_put(f, &num_positions, sizeof(num_positions));
+    checkpoint_put(f, positions, num_positions * sizeof(uint64_t));
+    for (uint64_t i = 0; i < num_caches; i++) {
+        cache *c = &caches[i];
+        uint64_t shape[CHECKPOINT_SHAPE];
+        checkpoint_shape(c, shape);
+        checkpoint_put(f, shape, sizeof(shape));
+        uint64_t counters[2] = {c->bip_count, c->shadow_count};
+        checkpoint_put(f, counters, sizeof(counters));
+        checkpoint_put_blocks(f, c, c->sets, NULL, c->indexNum * c->wayNum);
+        if (c->shadow != NULL) {
+            checkpoint_put_blocks(f, c, NULL, c->shadow, c->indexNum * c->wayNum);
+        }
+        checkpoint_put_blocks(f, c, NULL, c->vc.blocks, c->vc.entries);
+        uint64_t wbuf[2] = {c->wbuf.used, c->wbuf.ready};
+        checkpoint_put(f, wbuf, sizeof(wbuf));
+        checkpoint_put(f, c->wbuf.slots, c->wbuf.used * sizeof(wb_entry));
+        for (uint64_t j = 0; j < shape[11]; j++) {
+            uint64_t bank[2] = {c->banks[j].ready, c->banks[j].head};
+            checkpoint_put(f, bank, sizeof(bank));
+            checkpoint_put(f, c->banks[j].queue, shape[12] * sizeof(uint64_t));
+        }
+        if (c->dbp != NULL) {
+            checkpoint_put(f, c->dbp, (uint64_t)1 << DBP_ENTRIES_BITS);
+        }
+        checkpoint_put(f, c->way_pred, shape[14] * sizeof(uint32_t));
+        if (c->pf != NULL) {
+            prefetch_save(f, c->pf);
+        }
+        if (c->classifier != NULL) {
+            classifier_save(f, c->classifier);
+        }
+    }
+    uint64_t model = mem_model;
+    checkpoint_put(f, &model, sizeof(model));
+    if (mem_model == MEM_DRAM) {
+        dram_save(f);
+    }
+    fclose(f);
+}
+
+/**
+ * Function to load a checkpoint into the caches sim_init built
+ * The configuration has to give every cache the shape it had when the checkpoint
+ * was saved. The directory of a multi-core run is rebuilt from the private caches
+ *
+ * @param file Checkpoint file
+ * @param positions Filled with where the driver continues from
+ * @param num_positions Number of positions of this run, the same as when saved
+ */
+void checkpoint_restore(const char *file, uint64_t *positions, uint64_t num_positions)
+{
+    FILE *f = fopen(file, "rb");
+    if (f == NULL) {
+        print_error_exit("Could not open the checkpoint file\n");
+    }
+    char magic[4];
+    uint32_t version;
+    checkpoint_get(f, magic, sizeof(magic));
+    checkpoint_get(f, &version, sizeof(version));
+    if (memcmp(magic, "CSCP", 4) != 0 || version != CHECKPOINT_VERSION) {
+        print_error_exit("Not a checkpoint of this simulator version\n");
+    }
+    uint64_t clocks[5];
+    checkpoint_get(f, clocks, sizeof(clocks));
+    if (clocks[0] != num_caches || clocks[1] != num_cores) {
+        print_error_exit("Checkpoint is of a different hierarchy\n");
+    }
+    count = clocks[2];
+    cycle = clocks[3];
+    access_seq = clocks[4];
+    checkpoint_get(f, core_cycle, num_cores * sizeof(uint64_t));
+    if (checkpoint_get_u64(f) != num_positions) {
+        print_error_exit("Checkpoint is of a different number of traces\n");
+    }
+    checkpoint_get(f, positions, num_positions * sizeof(uint64_t));
+    for (uint64_t i = 0; i < num_caches; i++) {
+        cache *c = &caches[i];
+        uint64_t shape[CHECKPOINT_SHAPE];
+        uint64_t saved[CHECKPOINT_SHAPE];
+        checkpoint_shape(c, shape);
+        checkpoint_get(f, saved, sizeof(saved));
+        if (memcmp(shape, saved, sizeof(shape)) != 0) {
+            print_error_exit("Checkpoint is of a different hierarchy\n");
+        }
+        uint64_t counters[2];
+        checkpoint_get(f, counters, sizeof(counters));
+        c->bip_count = counters[0];
+        c->shadow_count = counters[1];
+        checkpoint_get_blocks(f, c, c->sets, NULL, c->indexNum * c->wayNum);
+        if (c->shadow != NULL) {
+            checkpoint_get_blocks(f, c, NULL, c->shadow, c->indexNum * c->wayNum);
+        }
+        checkpoint_get_blocks(f, c, NULL, c->vc.blocks, c->vc.entries);
+        c->wbuf.used = checkpoint_get_u64(f);
+        c->wbuf.ready = checkpoint_get_u64(f);
+        if (c->wbuf.used > c->wbuf.entries) {
+            print_error_exit("Checkpoint has too many write buffer entries\n");
+        }
+        checkpoint_get(f, c->wbuf.slots, c->wbuf.used * sizeof(wb_entry));
+        for (uint64_t j = 0; j < shape[11]; j++) {
+            c->banks[j].ready = checkpoint_get_u64(f);
+            c->banks[j].head = checkpoint_get_u64(f);
+            checkpoint_get(f, c->banks[j].queue, shape[12] * sizeof(uint64_t));
+        }
+        if (c->dbp != NULL) {
+            checkpoint_get(f, c->dbp, (uint64_t)1 << DBP_ENTRIES_BITS);
+        }
+        checkpoint_get(f, c->way_pred, shape[14] * sizeof(uint32_t));
+        if (c->pf != NULL) {
+            prefetch_restore(f, c->pf);
+        }
+        if (c->classifier != NULL) {
+            classifier_restore(f, c->classifier);
+        }
+    }
+    if (checkpoint_get_u64(f) != (uint64_t)mem_model) {
+        print_error_exit("Checkpoint is of a different main memory\n");
+    }
+    if (mem_model == MEM_DRAM) {
+        dram_restore(f);
+    }
+    fclose(f);
+    if (dir != NULL) {
+        for (uint64_t i = 0; i < num_caches; i++) {
+            cache *c = &caches[i];
+            for (uint64_t j = 0; c->coherent && j < c->indexNum * c->wayNum; j++) {
+                block *b = &c->sets[j / c->wayNum][j % c->wayNum];
+                if (b->valid) {
+                    coherence_track(c->core, restore_addr(c, b->tag, j / c->wayNum, j % c->wayNum));
+                }
+            }
+        }
+    }
 }
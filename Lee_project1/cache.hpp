@@ -21,11 +21,36 @@
 
 
 // Constants
-enum write_policy {WBWA = 1, WTWNA = 2};
+enum write_policy {WBWA = 1, WTWNA = 2, WBWNA = 3, WTWA = 4};
 enum replacement_policy {LRU = 1, LFU = 2, FIFO = 3};
+enum memory_model {MEM_FIXED = 1, MEM_DRAM = 2};
+enum dram_mapping {RO_BA_CH_CO = 1, RO_CO_BA_CH = 2, RO_BA_CH_CO_XOR = 3};
+enum prefetch_policy {NO_PREFETCH = 1, NEXT_LINE = 2, STRIDE = 3, STREAM_BUFFER = 4};
+enum inclusion_policy {NINE = 1, INCLUSIVE = 2, EXCLUSIVE = 3};
+enum level_sharing {PRIVATE = 1, SHARED = 2};
+enum scheduler_policy {ROUND_ROBIN = 1, LATENCY_ORDER = 2};
+enum page_size {PAGE_4K = 1, PAGE_2M = 2, PAGE_1G = 3};
+enum index_policy {BIT_SLICE = 1, XOR_INDEX = 2, SKEWED = 3};
+enum insertion_policy {INSERT_MRU = 1, INSERT_LIP = 2, INSERT_BIP = 3};
+enum way_prediction {NO_WAY_PREDICTION = 0, WAY_PREDICT_MRU = 1, WAY_PREDICT_TABLE = 2};
+enum output_format {OUTPUT_CSV = 1, OUTPUT_BINARY = 2};
+enum generator_pattern {GEN_SEQUENTIAL = 1, GEN_STRIDED = 2, GEN_UNIFORM = 3, GEN_ZIPF = 4, GEN_POINTER_CHASE = 5};
 
-static const char *const write_policy_map[] = {"NA", "WBWA", "WTWNA"};
+static const char *const write_policy_map[] = {"NA", "WBWA", "WTWNA", "WBWNA", "WTWA"};
 static const char *const replacement_policy_map[] = {"NA", "LRU", "LFU", "FIFO"};
+static const char *const memory_model_map[] = {"NA", "FIXED", "DRAM"};
+static const char *const dram_mapping_map[] = {"NA", "RoBaChCo", "RoCoBaCh", "XOR"};
+static const char *const prefetch_policy_map[] = {"NA", "NONE", "NEXT_LINE", "STRIDE", "STREAM"};
+static const char *const inclusion_policy_map[] = {"NA", "NINE", "INCLUSIVE", "EXCLUSIVE"};
+static const char *const level_sharing_map[] = {"NA", "PRIVATE", "SHARED"};
+static const char *const scheduler_policy_map[] = {"NA", "ROUND_ROBIN", "LATENCY"};
+static const char *const page_size_map[] = {"NA", "4K", "2M", "1G"};
+static const uint64_t PAGE_BITS[] = {0, 12, 21, 30};
+static const char *const index_policy_map[] = {"NA", "BIT_SLICE", "XOR", "SKEWED"};
+static const char *const generator_pattern_map[] = {"NA", "SEQUENTIAL", "STRIDED", "UNIFORM", "ZIPF", "POINTER_CHASE"};
+static const char *const insertion_policy_map[] = {"NA", "MRU", "LIP", "BIP"};
+static const char *const way_prediction_map[] = {"None", "MRU", "Table"};
+static const char *const output_format_map[] = {"NA", "CSV", "BINARY"};
 
 static const char LOAD = 'L';
 static const char STORE = 'S';
@@ -55,66 +80,336 @@ static const double L2_ACCESS_TIME[5][5] = {
     {15, 16, 18, 20, 22}    // FA
 };
 
+// Flat main memory latency used when no DRAM model is configured
+static const double MEM_ACCESS_TIME = 80;
+
+// Most blocks a prefetcher may request per trigger, and how far ahead of it
+static const uint64_t MAX_PREFETCH_DEGREE = 16;
+static const uint64_t MAX_PREFETCH_DISTANCE = 64;
+
+// Most cores, deepest hierarchy that can be configured, and the most caches it can hold
+// (split levels have two, private levels one or two per core)
+static const uint64_t MAX_CORES = 64;
+static const uint64_t MAX_LEVELS = 8;
+static const uint64_t MAX_CACHES = 4 * MAX_CORES + 2 * MAX_LEVELS;
+
+// Most banks a cache can be split into
+static const uint64_t MAX_BANKS = 16;
+
+// Latency histogram buckets: values below 2^LATENCY_SUB_BITS are exact, larger
+// ones keep LATENCY_SUB_BITS significant bits (under 1.6% error)
+static const uint64_t LATENCY_SUB_BITS = 6;
+static const uint64_t LATENCY_BUCKETS = (65 - LATENCY_SUB_BITS) << LATENCY_SUB_BITS;
+
+// Most C columns a level's access time table can have
+static const uint64_t MAX_TABLE_C = 8;
+
 // Struct for storing per Cache parameters
 struct cache_config_t {
     uint64_t c;
-    uint64_t b; // We assume that both the caches have the exact same block size
+    uint64_t b; // may grow from one level to the next
     uint64_t s;
+    uint64_t sectors;        // sectors per block, 1 = not sectored
+    enum index_policy indexing; // set index function
+    enum insertion_policy insertion; // replacement position of a new block
+    bool bypass;             // demand fills predicted dead skip the cache
+    enum way_prediction way_pred; // way predictor of a first level cache
+    uint64_t fast_hit_time;  // hit time in the predicted way (0 = the direct mapped hit time)
+    uint64_t mispredict_penalty; // cycles of the second probe after a wrong prediction
+    uint64_t banks;          // independently accessed banks, 1 = a single array
+    uint64_t bank_bit;       // lowest address bit of the bank select (0 = just above the block offset)
+    uint64_t bank_busy;      // cycles an access holds its bank
+    uint64_t bank_queue;     // accesses a bank can have in flight before the core stalls
+    enum prefetch_policy pf; // prefetcher attached to this cache
+    uint64_t pf_degree;      // blocks requested per trigger
+    uint64_t pf_distance;    // how many blocks ahead of the trigger the first request is
+    uint64_t vc_entries;     // victim cache entries (0 = none)
+    uint64_t vc_hit_time;    // victim cache hit time
+    uint64_t wb_entries;     // coalescing write buffer entries below the cache (0 = none)
+    uint64_t class_ways[3];  // ways instruction, load and store fills may replace (0 = all)
+    uint64_t core_ways[MAX_CORES]; // ways the fills of each core may replace (0 = all)
+};
+
+// Struct for storing the parameters of one level of the hierarchy
+struct level_config_t {
+    char name[16];                   // printed name, e.g. "L2"
+    bool split;                      // separate instruction and data caches
+    struct cache_config_t inst;      // instruction cache of a split level
+    struct cache_config_t data;      // data cache of a split level, or the unified cache
+    enum write_policy wp;            // 0 = the hierarchy default
+    enum replacement_policy rp;      // 0 = the hierarchy default
+    enum inclusion_policy inclusion; // relation to the levels above, 0 = the hierarchy default
+    enum level_sharing sharing;      // one copy per core or one for all, 0 = private L1 and shared below
+    double hit_time;                 // fixed hit time, 0 = look it up in access_time
+    uint64_t min_c;                  // C of the first column of access_time
+    uint64_t max_c;                  // C of the last column of access_time (0 = no table)
+    double access_time[5][MAX_TABLE_C]; // hit times by associativity (DM, 2W, 4W, 8W, FA) and C
+};
+
+// Struct for keeping track of one prefetcher's statistics
+struct prefetch_stats_t {
+    uint64_t num_issued;                    // Prefetches that brought a block into the cache
+    uint64_t num_useful;                    // Prefetched blocks later hit by a demand access
+    uint64_t num_late;                      // Useful prefetches still in flight when the demand arrived
+    uint64_t num_polluting;                 // Demand misses on blocks a prefetch fill evicted
+};
+
+// Struct for keeping track of one victim cache's statistics
+struct victim_stats_t {
+    uint64_t num_accesses;                  // Cache misses that probed the victim cache
+    uint64_t num_hits;                      // Blocks swapped back into the cache
+    uint64_t num_evictions;                 // Blocks pushed out of the victim cache
+    uint64_t num_write_backs;               // Dirty blocks pushed out into the next level
+
+    double hit_time;                        // Victim Cache Hit Time
+    double miss_rate;                       // Victim Cache Miss Rate
+};
+
+// Struct for keeping track of one write buffer's statistics
+struct write_buffer_stats_t {
+    uint64_t num_writes;                    // Stores that entered the write buffer
+    uint64_t num_merges;                    // Stores merged into an entry for the same block
+    uint64_t num_full_stalls;               // Stores that waited for the oldest entry to drain
+    uint64_t num_stall_cycles;              // Cycles stores waited for a full buffer
+    uint64_t num_drains;                    // Entries written to the next level
+    uint64_t num_bytes_written;             // Bytes of the stores that entered the buffer
+    uint64_t num_bytes_drained;             // Bytes the drained entries wrote to the next level
+
+    double merge_rate;                      // Write Buffer Merge Rate
+    double traffic_reduction;               // Fraction of the stored bytes the buffer did not pass on
+};
+
+// Struct for storing main memory parameters
+struct mem_config_t {
+    enum memory_model model;
+    enum dram_mapping mapping;  // address interleaving scheme
+    uint64_t channels;          // number of channels (power of 2)
+    uint64_t banks;             // banks per channel (power of 2)
+    uint64_t row_size;          // row buffer size in bytes (power of 2)
+    uint64_t row_hit_time;      // cycles for a column access to the open row
+    uint64_t row_miss_time;     // cycles to activate a row in a precharged bank
+    uint64_t row_conflict_time; // cycles to precharge, activate and access
+    uint64_t bus_time;          // data bus cycles needed to transfer one block
+    uint64_t queue_depth;       // outstanding requests per channel before the requester stalls
+};
+
+// Struct for storing the parameters of one TLB
+struct tlb_config_t {
+    uint64_t entries;   // translations held (0 = no TLB)
+    uint64_t s;         // log2 of the associativity
+    double hit_time;    // cycles added to every access that looks it up
+};
+
+// Struct for storing the virtual memory parameters
+struct vm_config_t {
+    enum page_size page;        // 0 = trace addresses are physical, no TLBs
+    struct tlb_config_t itlb;   // first level instruction TLB
+    struct tlb_config_t dtlb;   // first level data TLB
+    struct tlb_config_t stlb;   // second level TLB shared by instructions and data
+};
+
+// Struct for storing where the per-cache distributions are written
+struct analysis_config_t {
+    char file[256];             // output file, empty = no analysis
+    enum output_format format;
+    uint64_t top_misses;        // entries of the list of blocks that missed most
+};
+
+// Struct for storing the windows of the time series output
+struct timeseries_config_t {
+    char file[256];             // output file, empty = no time series
+    enum output_format format;
+    uint64_t interval;          // accesses or cycles per window
+    bool cycles;                // windows of core cycles instead of accesses
+};
+
+// Struct for storing the checkpoint of the hierarchy a run saves or starts from
+struct checkpoint_config_t {
+    char save[256];             // file written once the run reaches at, empty = none
+    uint64_t at;                // accesses before the checkpoint, 0 = end of the traces
+    char restore[256];          // checkpoint the run starts from, empty = cold caches
+};
+
+// Struct for storing the part of a single trace a run simulates
+struct region_config_t {
+    uint64_t skip;              // accesses fast-forwarded before the region
+    uint64_t warm_up;           // accesses simulated before each segment, left out of the statistics
+    uint64_t accesses;          // accesses of the region, 0 = to the end of the trace
+    uint64_t segments;          // parts of the region simulated in parallel
+};
+
+// Struct for storing the synthetic accesses a run simulates instead of a trace
+struct generator_config_t {
+    enum generator_pattern pattern; // 0 = no generator
+    uint64_t accesses;          // accesses over all cores
+    uint64_t seed;
+    uint64_t working_set;       // bytes the data accesses stay in
+    uint64_t stride;            // bytes between strided accesses
+    double zipf_exponent;       // skew of the Zipf hot set, 0 is uniform
+    uint64_t size;              // bytes per access, 0 = not given like a trace without sizes
+    uint64_t mix[3];            // weights of Instructions, Loads and Stores
+    uint64_t code_size;         // bytes of the loop the instructions run through
 };
 
 // Struct for tracking the simulation parameters
 struct sim_config_t {
-    struct cache_config_t l1data;
-    struct cache_config_t l1inst;
-    struct cache_config_t l2unified;
-    enum write_policy wp; // write policy
-    enum replacement_policy rp; // replacement policy
+    struct level_config_t levels[MAX_LEVELS]; // levels[0] is closest to the core
+    uint64_t num_levels;
+    struct mem_config_t mem;
+    enum write_policy wp; // default write policy of the levels
+    enum replacement_policy rp; // default replacement policy of the levels
+    enum inclusion_policy inclusion; // default inclusion policy of the levels below L1
+    uint64_t issue_interval; // cycles between two consecutive accesses of a core
+    uint64_t cores; // cores sharing the levels below the private ones
+    enum scheduler_policy scheduler; // interleaving of per-core traces
+    struct vm_config_t vm; // address translation
+    bool classify_misses; // compulsory, capacity and conflict miss classification
+    bool latency_histogram; // per-access latency percentiles
+    struct analysis_config_t analysis; // reuse distance, set pressure and top missing blocks
+    struct timeseries_config_t timeseries; // per-window statistics
+    char event_log[256]; // binary log of hits, misses, fills and evictions, empty = none
+    struct checkpoint_config_t checkpoint; // warm start from a saved hierarchy
+    struct region_config_t region; // region of interest and parallel segments
+    struct generator_config_t generator; // synthetic accesses instead of a trace
+};
+
+// Struct for keeping track of one cache's statistics
+struct cache_stats_t {
+    char name[64];                          // Printed name, e.g. "L1 Data" or "Core 1 L1 Data"
+    uint64_t level;                         // Level of the cache, 0 is closest to the core
+    int64_t core;                           // Core owning a private cache, -1 if shared
+    bool insts;                             // Serves instruction accesses
+    bool data;                              // Serves loads and stores
+
+    uint64_t num_accesses;                  // Total Accesses
+    uint64_t num_accesses_insts;            // Accesses which are instructions
+    uint64_t num_accesses_loads;            // Accesses which are Loads
+    uint64_t num_accesses_stores;           // Accesses which are Stores
+    uint64_t num_misses;                    // Total Misses
+    uint64_t num_misses_insts;              // Misses that are instructions
+    uint64_t num_misses_loads;              // Misses that are Loads
+    uint64_t num_misses_stores;             // Misses that are Stores
+    uint64_t num_sector_misses;             // Misses on a block that was there without the sector
+    uint64_t num_bit_slice_misses;          // Misses of the same cache with bit-slice indexing (hashed indexing only)
+    uint64_t num_class_misses[3][3];        // Misses by class (compulsory, capacity, conflict) and type (I, L, S), classification only
+    uint64_t num_evictions;                 // Total blocks evicted from the cache
+    uint64_t num_write_backs;               // Dirty blocks written back to the next level
+    uint64_t num_bytes_transferred;         // Bytes moved between the cache and the next level
+    uint64_t num_back_invalidations;        // Upper level copies invalidated by inclusive evictions
+    uint64_t num_back_invalidation_write_backs; // Evictions written back because an upper copy was dirty
+
+    double hit_time;                        // Hit Time
+    double miss_penalty;                    // Miss Penalty
+    double miss_rate;                       // Miss Rate
+    double AAT;                             // Average Access Time
+    double conflict_miss_reduction;         // Fraction of the bit-slice misses hashed indexing avoided
+
+    // Way prediction statistics (way predicted caches only)
+    uint64_t num_way_hits;                  // Hits in the predicted way
+    uint64_t num_way_mispredictions;        // Hits in another way, found by the second probe
+    double way_prediction_accuracy;         // Way Prediction Accuracy over the hits
+
+    // Bank statistics (banked caches only)
+    uint64_t num_bank_conflicts;            // Accesses and write backs that found their bank busy
+    uint64_t num_bank_conflict_cycles;      // Total cycles they waited for the bank
+    uint64_t num_bank_queue_stalls;         // Accesses that found their bank queue full and stalled the core
+    uint64_t bank_accesses[MAX_BANKS];      // Accesses and write backs by bank
+    uint64_t bank_busy_cycles[MAX_BANKS];   // Cycles each bank was held
+    double bank_utilization[MAX_BANKS];     // Share of the simulated cycles each bank was held
+
+    // Dead block prediction statistics (bypassing caches only)
+    uint64_t num_bypasses;                  // Demand fills predicted dead that skipped the cache
+    uint64_t num_dead_evictions;            // Blocks evicted without a hit since their fill
+    uint64_t num_predictions_checked;       // Evicted blocks whose prediction at fill time was checked
+    uint64_t num_predictions_correct;       // Checked predictions that matched the block's reuse
+    double predictor_accuracy;              // Dead Block Predictor Accuracy
+
+    // Way partitioning statistics (partitioned caches only)
+    uint64_t num_core_misses[MAX_CORES];    // Misses by core
+    double class_occupancy[3];              // Share of the blocks last filled for Instructions, Loads and Stores at the end
+    double core_occupancy[MAX_CORES];       // Share of the blocks last filled for each core at the end
+
+    struct victim_stats_t victim;           // Victim Cache statistics
+    struct write_buffer_stats_t write_buffer; // Write Buffer statistics
+    struct prefetch_stats_t prefetch;       // Prefetcher statistics
+};
+
+// Struct for keeping track of one TLB's statistics, summed over the cores
+struct tlb_stats_t {
+    uint64_t num_accesses;                  // Translations looked up
+    uint64_t num_misses;                    // Translations not found
+
+    double hit_time;                        // TLB Hit Time
+    double miss_rate;                       // TLB Miss Rate
+};
+
+// Struct for keeping track of the latencies of one type of access, in whole cycles
+struct latency_histogram_t {
+    uint64_t counts[LATENCY_BUCKETS];       // Accesses by log-linear latency bucket
+    uint64_t total;                         // Accesses recorded
+    uint64_t percentiles[4];                // p50, p90, p99 and p99.9 latency
+};
+
+// Struct for keeping track of one core's statistics
+struct core_stats_t {
+    uint64_t num_accesses;                  // Accesses issued by the core
+    uint64_t num_invalidations;             // Private copies invalidated by stores of other cores
+    uint64_t num_upgrades;                  // Stores to shared copies that had to invalidate the other copies
+    uint64_t num_c2c_transfers;             // Modified blocks forwarded to another core
+
+    double inst_avg_access_time;            // Average Access Time of the core's Instructions
+    double data_avg_access_time;            // Average Access Time of the core's Loads and Stores
+    double avg_access_time;                 // Average Access Time of the core
 };
 
 // Struct for keeping track of simulation statistics
 struct sim_stats_t {
 
-    // L1 Instruction Cache statistics
-    uint64_t l1inst_num_accesses;           // Total L1 Inst Accesses
-    uint64_t l1inst_num_misses;             // Total L1 Inst Misses
-    uint64_t l1inst_num_evictions;          // Total blocks evicted from L1-Instruction cache
-
-    double l1inst_hit_time;                 // L1 Inst Hit Time
-    double l1inst_miss_penalty;             // L1 Inst Miss Penalty
-    double l1inst_miss_rate;                // L1 Inst Miss Rate
-    double l1inst_AAT;                      // L1 Inst Average Access Time
-
-    // L1 Data Cache statistics
-    uint64_t l1data_num_accesses;           // Total L1 Data Accesses
-    uint64_t l1data_num_accesses_loads;     // L1 Data Accesses which are Loads
-    uint64_t l1data_num_accesses_stores;    // L1 Data Accesses which are Stores
-    uint64_t l1data_num_misses;             // Total L1 Data Misses
-    uint64_t l1data_num_misses_loads;       // L1 Data Misses which are Loads
-    uint64_t l1data_num_misses_stores;      // L1 Data Misses which are Stores
-    uint64_t l1data_num_evictions;          // Total blocks evicted from L1-Data cache
-
-    double l1data_hit_time;                 // L1 Data Hit Time
-    double l1data_miss_penalty;             // L1 Data Miss Penalty
-    double l1data_miss_rate;                // L1 Data Miss Rate
-    double l1data_AAT;                      // L1 Data Average Access Time
-
-    // Unified L2 Cache statistics
-    uint64_t l2unified_num_accesses;        // Total L2 Accesses
-    uint64_t l2unified_num_accesses_insts;  // L2 Accesses which are instructions
-    uint64_t l2unified_num_accesses_loads;  // L2 Accesses which are Loads
-    uint64_t l2unified_num_accesses_stores; // L2 Accesses which are Stores
-    uint64_t l2unified_num_misses;          // Total L2 Misses
-    uint64_t l2unified_num_misses_insts;    // L2 Misses that are instructions
-    uint64_t l2unified_num_misses_loads;    // L2 Misses that are Loads
-    uint64_t l2unified_num_misses_stores;   // L2 Misses that are Stores
-    uint64_t l2unified_num_evictions;       // Total blocks evicted from the L2 cache
-    uint64_t l2unified_num_write_backs;     // Total write backs from L2 to Main Memory
-    uint64_t l2unified_num_bytes_transferred; // Total bytes written from L2 to Main Memory
-
-    double l2unified_hit_time;              // L2 Hit Time
-    double l2unified_miss_penalty;          // L2 Miss Penalty
-    double l2unified_miss_rate;             // L2 Miss Rate
-    double l2unified_AAT;                   // L2 Average Access Time
+    // Cache statistics, numbered level by level with the instruction cache of a split level first
+    struct cache_stats_t caches[MAX_CACHES];
+    uint64_t num_caches;
+
+    // Core statistics (multi-core only)
+    struct core_stats_t cores[MAX_CORES];
+
+    // Access size statistics (traces with sizes only)
+    uint64_t num_sized_accesses;            // Accesses that gave their size
+    uint64_t num_split_accesses;            // Accesses that crossed a first level block and took several lookups
+
+    // Translation statistics (virtual memory only)
+    struct tlb_stats_t itlb;
+    struct tlb_stats_t dtlb;
+    struct tlb_stats_t stlb;
+    uint64_t num_page_walks;                // Translations that missed in every TLB
+    uint64_t num_walk_accesses;             // PTE loads the walks issued to the data caches
+    uint64_t walk_cycles;                   // Total cycles spent walking the page table
+    double avg_walk_time;                   // Average Page Walk Time
+    double inst_translation_time;           // Average translation cycles added to Instructions
+    double data_translation_time;           // Average translation cycles added to Loads and Stores
+
+    // Inclusion statistics
+    uint64_t effective_capacity;            // Bytes of distinct blocks held by the hierarchy at the end
+    double effective_capacity_gain;         // Effective capacity relative to the last level capacity
+
+    // Prefetcher statistics
+    double prefetch_AAT_change;             // Overall AAT minus the estimated AAT without prefetching
+
+    // Main Memory statistics (DRAM model only)
+    uint64_t mem_num_reads;                 // Blocks read from DRAM
+    uint64_t mem_num_writes;                // Blocks written to DRAM
+    uint64_t mem_num_row_hits;              // Requests that hit the open row
+    uint64_t mem_num_row_misses;            // Requests to a precharged bank
+    uint64_t mem_num_row_conflicts;         // Requests that had to close another row
+    uint64_t mem_num_queue_stalls;          // Requests that found the channel queue full
+    uint64_t mem_read_cycles;               // Total cycles spent on DRAM reads
+    uint64_t mem_queue_cycles;              // Total cycles requests waited for a bank or the bus
+
+    double mem_row_hit_rate;                // Row Buffer Hit Rate
+    double mem_avg_read_latency;            // Average DRAM read latency - the last level miss penalty
+    double mem_avg_queue_delay;             // Average cycles a request waited in the queue
+
+    // Latency statistics (latency histogram only), for Instructions, Loads and Stores
+    struct latency_histogram_t latency[3];
 
     // Performance Statistics
     double inst_avg_access_time;            // Average Access Time per access for Instructions
@@ -125,6 +420,15 @@ struct sim_stats_t {
 // Visible functions
 void sim_init(struct sim_config_t *sim_conf);
 void cache_access(uint64_t addr, char type, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf);
+uint64_t core_access(uint64_t core, uint64_t addr, char type, uint64_t size, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf);
+void sim_warm_up_end(const struct sim_config_t *sim_conf);
 void sim_cleanup(struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf);
+void sim_stats_merge(struct sim_stats_t *into, const struct sim_stats_t *from, uint64_t segments, bool last);
+void checkpoint_save(const char *file, const uint64_t *positions, uint64_t num_positions);
+void checkpoint_restore(const char *file, uint64_t *positions, uint64_t num_positions);
+void checkpoint_put(FILE *f, const void *p, size_t n);
+void checkpoint_get(FILE *f, void *p, size_t n);
+uint64_t checkpoint_get_u64(FILE *f);
+double level_hit_time(const struct level_config_t *level, const struct cache_config_t *cache);
 
 #endif // CACHE_H
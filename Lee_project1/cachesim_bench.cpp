@@ -0,0 +1,325 @@
+/**
+ * @file cachesim_bench.cpp
+ * @brief Throughput benchmark of the cache simulator
+ *
+ * Runs a simulator binary over a fixed matrix of configurations, direct
+ * mapped through fully associative for every replacement and write policy,
+ * on the built-in generators and on recorded traces given with -i. Each
+ * configuration and workload is run a few times to warm up, then timed over
+ * repeated runs. The startup of a configuration, a run of no accesses, is
+ * taken off every run, so ns/access is the cost of the accesses alone; for a
+ * recorded trace that includes reading the trace.
+ *
+ * Timing a separate binary lets the results of builds be compared: build the
+ * simulator, run the benchmark with -x <binary> -l <label> and keep the
+ * results files. A results file is CSV with one row per configuration and
+ * workload:
+ *     label,config,workload,accesses,reps,median_ns,stddev_ns,min_ns,accesses_per_sec,peak_rss_kb
+ * where the ns columns are per access and peak_rss_kb is the most resident
+ * memory of any run.
+ *
+ * Build: g++ -std=c++11 -O2 cachesim_bench.cpp -o cachesim_bench
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_TRACES 16
+#define MAX_REPS 100
+
+// Associativities of the matrix, as S of the L1 caches and of the L2
+static const char *const ASSOC_NAMES[] = {"DM", "W2", "W4", "W8", "FA"};
+static const uint64_t L1_S[] = {0, 1, 2, 3, 4};
+static const uint64_t L2_S[] = {0, 1, 2, 3, 11};
+static const uint64_t NUM_ASSOC = 5;
+static const uint64_t L1_C = 10;
+static const uint64_t L2_C = 17;
+static const uint64_t B = 6;
+
+static const char *const POLICIES[] = {"LRU", "LFU", "FIFO"};
+static const char *const WRITE_POLICIES[] = {"WBWA", "WTWNA"};
+static const char *const PATTERNS[] = {"Sequential", "Uniform", "Zipf", "Pointer Chase"};
+static const uint64_t NUM_PATTERNS = 4;
+
+// Print error usage
+static void print_err_usage(const char *err)
+{
+    fprintf(stderr, "%s\n", err);
+
+    fprintf(stderr, "./cachesim_bench [-x <simulator>] [-l <label>] [-o <results file>] [-n <generated accesses>]\n");
+    fprintf(stderr, "                 [-r <timed runs>] [-w <warm up runs>] [-i <trace file> ...]\n");
+
+    exit(EXIT_FAILURE);
+}
+
+// Write the configuration of one point of the matrix, generating accesses if pattern is given
+static void write_config(const char *file, uint64_t assoc, const char *rp, const char *wp, const char *pattern,
+                         uint64_t accesses)
+{
+    FILE *out = fopen(file, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Could not write the configuration %s\n", file);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "    \"L1 Instruction\": {\"C\": %" PRIu64 ", \"B\": %" PRIu64 ", \"S\": %" PRIu64 "},\n", L1_C, B, L1_S[assoc]);
+    fprintf(out, "    \"L1 Data\": {\"C\": %" PRIu64 ", \"B\": %" PRIu64 ", \"S\": %" PRIu64 "},\n", L1_C, B, L1_S[assoc]);
+    fprintf(out, "    \"L2 Unified\": {\"C\": %" PRIu64 ", \"B\": %" PRIu64 ", \"S\": %" PRIu64 "},\n", L2_C, B, L2_S[assoc]);
+    if (pattern != NULL) {
+        fprintf(out, "    \"Generator\": {\"Pattern\": \"%s\", \"Accesses\": %" PRIu64 ", \"Seed\": 1, \"Mix\": [25, 50, 25]},\n",
+                pattern, accesses);
+    }
+    fprintf(out, "    \"Replacement Policy\": \"%s\",\n", rp);
+    fprintf(out, "    \"Write Policy\": \"%s\"\n", wp);
+    fprintf(out, "}\n");
+    fclose(out);
+}
+
+// Count the accesses of a recorded trace, one per line
+static uint64_t count_accesses(const char *file)
+{
+    FILE *trace = fopen(file, "r");
+    if (trace == NULL) {
+        fprintf(stderr, "Could not open the trace %s\n", file);
+        exit(EXIT_FAILURE);
+    }
+    char line[128];
+    uint64_t n = 0;
+    while (fgets(line, sizeof(line), trace) != NULL) {
+        if (line[0] != '\n' && line[0] != '\0') {
+            n++;
+        }
+    }
+    fclose(trace);
+    return n;
+}
+
+/**
+ * Function to run the simulator once with its output thrown away
+ * Returns the wall clock seconds of the run
+ *
+ * @param sim Simulator binary
+ * @param conf Configuration file
+ * @param trace Trace file, NULL if the configuration generates the accesses
+ * @param rss_kb Set to the peak resident memory of the run
+ */
+static double run_once(const char *sim, const char *conf, const char *trace, long *rss_kb)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        if (trace != NULL) {
+            execl(sim, sim, "-c", conf, "-i", trace, (char*) NULL);
+        } else {
+            execl(sim, sim, "-c", conf, (char*) NULL);
+        }
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4");
+        exit(EXIT_FAILURE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s failed on %s%s%s\n", sim, conf, trace != NULL ? " with " : "", trace != NULL ? trace : "");
+        exit(EXIT_FAILURE);
+    }
+    *rss_kb = usage.ru_maxrss;
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+// Run warm_up untimed runs, then reps timed ones into seconds
+// Returns the peak resident memory over the timed runs
+static long measure(const char *sim, const char *conf, const char *trace, uint64_t warm_up, uint64_t reps, double *seconds)
+{
+    long rss = 0;
+    long peak = 0;
+    for (uint64_t i = 0; i < warm_up; i++) {
+        run_once(sim, conf, trace, &rss);
+    }
+    for (uint64_t i = 0; i < reps; i++) {
+        seconds[i] = run_once(sim, conf, trace, &rss);
+        peak = rss > peak ? rss : peak;
+    }
+    return peak;
+}
+
+static double median(const double *values, uint64_t n)
+{
+    double sorted[MAX_REPS];
+    memcpy(sorted, values, n * sizeof(double));
+    std::sort(sorted, sorted + n);
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+// Sample standard deviation, 0 for a single run
+static double stddev(const double *values, uint64_t n)
+{
+    if (n < 2) {
+        return 0;
+    }
+    double mean = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        mean += values[i];
+    }
+    mean /= (double)n;
+    double sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        sum += (values[i] - mean) * (values[i] - mean);
+    }
+    return sqrt(sum / (double)(n - 1));
+}
+
+// Drive the benchmark
+int main(int argc, char *const argv[])
+{
+    const char *sim = "./cachesim";
+    const char *label = NULL;
+    const char *results = "bench.csv";
+    const char *traces[MAX_TRACES];
+    uint64_t num_traces = 0;
+    uint64_t accesses = 200000;
+    uint64_t reps = 5;
+    uint64_t warm_up = 1;
+
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "x:l:o:n:r:w:i:h"))) {
+        switch (opt) {
+            case 'x':
+                sim = optarg;
+                break;
+            case 'l':
+                label = optarg;
+                break;
+            case 'o':
+                results = optarg;
+                break;
+            case 'n':
+                accesses = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                reps = strtoull(optarg, NULL, 10);
+                break;
+            case 'w':
+                warm_up = strtoull(optarg, NULL, 10);
+                break;
+            case 'i':
+                if (num_traces == MAX_TRACES) {
+                    print_err_usage("Too many trace files");
+                }
+                traces[num_traces++] = optarg;
+                break;
+            case 'h':
+                print_err_usage("");
+                break;
+            default:
+                print_err_usage("Invalid argument to program");
+                break;
+        }
+    }
+    if (reps == 0 || reps > MAX_REPS) {
+        print_err_usage("Timed runs must be between 1 and 100");
+    }
+    if (accesses == 0) {
+        print_err_usage("Generated accesses must be at least 1");
+    }
+    if (access(sim, X_OK) != 0) {
+        print_err_usage("Could not run the simulator");
+    }
+    label = label != NULL ? label : sim;
+
+    uint64_t trace_accesses[MAX_TRACES];
+    for (uint64_t t = 0; t < num_traces; t++) {
+        trace_accesses[t] = count_accesses(traces[t]);
+    }
+
+    char dir[] = "/tmp/cachesim_bench.XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        exit(EXIT_FAILURE);
+    }
+    char conf[sizeof(dir) + 16];
+    snprintf(conf, sizeof(conf), "%s/bench.conf", dir);
+
+    FILE *out = fopen(results, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Could not open the results file %s\n", results);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(out, "label,config,workload,accesses,reps,median_ns,stddev_ns,min_ns,accesses_per_sec,peak_rss_kb\n");
+
+    fprintf(stdout, "%-16s %-16s %12s %14s %10s %10s %12s\n", "Config", "Workload", "Accesses", "Accesses/sec",
+            "ns/access", "Stddev", "Peak RSS KB");
+    double seconds[MAX_REPS];
+    double ns[MAX_REPS];
+    for (uint64_t a = 0; a < NUM_ASSOC; a++) {
+        for (int p = 0; p < 3; p++) {
+            for (int w = 0; w < 2; w++) {
+                char name[32];
+                snprintf(name, sizeof(name), "%s_%s_%s", ASSOC_NAMES[a], POLICIES[p], WRITE_POLICIES[w]);
+
+                //startup of the configuration, taken off every run
+                write_config(conf, a, POLICIES[p], WRITE_POLICIES[w], PATTERNS[0], 0);
+                measure(sim, conf, NULL, warm_up, reps, seconds);
+                double startup = median(seconds, reps);
+
+                for (uint64_t k = 0; k < NUM_PATTERNS + num_traces; k++) {
+                    char workload[64];
+                    uint64_t n;
+                    long rss;
+                    if (k < NUM_PATTERNS) {
+                        snprintf(workload, sizeof(workload), "%s", PATTERNS[k]);
+                        n = accesses;
+                        write_config(conf, a, POLICIES[p], WRITE_POLICIES[w], PATTERNS[k], accesses);
+                        rss = measure(sim, conf, NULL, warm_up, reps, seconds);
+                    } else {
+                        const char *trace = traces[k - NUM_PATTERNS];
+                        const char *base = strrchr(trace, '/');
+                        snprintf(workload, sizeof(workload), "%s", base != NULL ? base + 1 : trace);
+                        n = trace_accesses[k - NUM_PATTERNS];
+                        write_config(conf, a, POLICIES[p], WRITE_POLICIES[w], NULL, 0);
+                        rss = measure(sim, conf, trace, warm_up, reps, seconds);
+                    }
+                    for (uint64_t i = 0; i < reps; i++) {
+                        double run = seconds[i] > startup ? seconds[i] - startup : 0;
+                        ns[i] = n ? run * 1e9 / (double)n : 0;
+                    }
+                    double med = median(ns, reps);
+                    double sd = stddev(ns, reps);
+                    double min = *std::min_element(ns, ns + reps);
+                    double rate = med > 0 ? 1e9 / med : 0;
+                    fprintf(stdout, "%-16s %-16s %12" PRIu64 " %14.0f %10.2f %10.2f %12ld\n", name, workload, n, rate, med, sd, rss);
+                    fprintf(out, "%s,%s,%s,%" PRIu64 ",%" PRIu64 ",%.3f,%.3f,%.3f,%.0f,%ld\n", label, name, workload, n, reps,
+                            med, sd, min, rate, rss);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    fclose(out);
+    unlink(conf);
+    rmdir(dir);
+    return 0;
+}
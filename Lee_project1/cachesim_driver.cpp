@@ -9,6 +9,8 @@
 
 #include <getopt.h>
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 
 #include <cstdarg>
@@ -21,6 +23,15 @@
 
 #include "util/jsmn.h"
 #include "cache.hpp"
+#include "generator.hpp"
+#include "scheduler.hpp"
+#include "shm_ring.hpp"
+#include "trace_index.hpp"
+
+// Most segments a region is split into, one process each
+#define MAX_SEGMENTS 64
+// Records taken out of a shared memory ring at a time
+#define RING_BATCH 1024
 
 
 // Print error usage
@@ -28,7 +39,9 @@ static void print_err_usage(std::string err)
 {
     fprintf(stderr, "%s\n", err.c_str());
 
-    fprintf(stderr, "./cachesim -c <configuration file> -i <trace file>\n");
+    fprintf(stderr, "./cachesim -c <configuration file> -i <trace file> [-i <trace file of the next core> ...]\n");
+    fprintf(stderr, "./cachesim -c <configuration file> -s <shared memory ring of a producer>\n");
+    fprintf(stderr, "./cachesim -c <configuration file with a Generator>\n");
     fprintf(stderr, "Look at default.conf for example configuration file\n");
 
     exit(EXIT_FAILURE);
@@ -38,69 +51,448 @@ static inline void print_error_exit(const char *msg, ...)
 {
     va_list argptr;
     va_start(argptr, msg);
-    fprintf(stderr, msg, argptr);
+    vfprintf(stderr, msg, argptr);
     va_end(argptr);
     exit(EXIT_FAILURE);
 }
 
+// Helper to name a cache of a level, split levels have an instruction and a data cache
+static void cache_name(char *name, size_t len, const struct level_config_t *level, int side)
+{
+    if (!level->split) {
+        snprintf(name, len, "%s", level->name);
+    } else {
+        snprintf(name, len, "%s %s", level->name, side == 0 ? "Instruction" : "Data");
+    }
+}
+
+// Helper to check if a run simulates only part of its trace or splits it into segments
+static bool has_region(const struct sim_config_t *sim_conf)
+{
+    return sim_conf->region.skip || sim_conf->region.warm_up || sim_conf->region.accesses || sim_conf->region.segments > 1;
+}
+
 // Function to print the run configuration
 static void print_sim_config(struct sim_config_t *sim_conf)
 {
+    char name[32];
+    char label[64];
+    bool uniform_rp = true;
+    bool uniform_wp = true;
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        uniform_rp = uniform_rp && sim_conf->levels[k].rp == sim_conf->levels[0].rp;
+        uniform_wp = uniform_wp && sim_conf->levels[k].wp == sim_conf->levels[0].wp;
+    }
+
     fprintf(stdout, "SIMULATION CONFIGURATION\n");
-    fprintf(stdout, "L1 Instruction Cache:  (C=%" PRIu64 ", B=%" PRIu64 ", S=%" PRIu64 ")\n", sim_conf->l1inst.c, sim_conf->l1inst.b, sim_conf->l1inst.s);
-    fprintf(stdout, "L1 Data Cache:         (C=%" PRIu64 ", B=%" PRIu64 ", S=%" PRIu64 ")\n", sim_conf->l1data.c, sim_conf->l1data.b, sim_conf->l1data.s);
-    fprintf(stdout, "L2 Unified Cache:      (C=%" PRIu64 ", B=%" PRIu64 ", S=%" PRIu64 ")\n", sim_conf->l2unified.c, sim_conf->l2unified.b, sim_conf->l2unified.s);
-    fprintf(stdout, "Replacement Policy:    %s\n", replacement_policy_map[sim_conf->rp]);
-    fprintf(stdout, "Write Policy:          %s\n", write_policy_map[sim_conf->wp]);
+    if (sim_conf->cores > 1) {
+        uint64_t private_levels = 0;
+        while (private_levels < sim_conf->num_levels && sim_conf->levels[private_levels].sharing == PRIVATE) {
+            private_levels++;
+        }
+        fprintf(stdout, "Cores:                 %" PRIu64 " (Private Levels=%" PRIu64 ", Scheduler=%s)\n",
+                sim_conf->cores, private_levels, scheduler_policy_map[sim_conf->scheduler]);
+    }
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        for (int side = level->split ? 0 : 1; side < 2; side++) {
+            const struct cache_config_t *cache = side == 0 ? &level->inst : &level->data;
+            cache_name(name, sizeof(name), level, side);
+            snprintf(label, sizeof(label), "%s%s Cache:", name, level->split ? "" : " Unified");
+            if (cache->sectors > 1) {
+                fprintf(stdout, "%-23s(C=%" PRIu64 ", B=%" PRIu64 ", S=%" PRIu64 ", Sectors=%" PRIu64 ")\n", label,
+                        cache->c, cache->b, cache->s, cache->sectors);
+            } else {
+                fprintf(stdout, "%-23s(C=%" PRIu64 ", B=%" PRIu64 ", S=%" PRIu64 ")\n", label, cache->c, cache->b, cache->s);
+            }
+        }
+    }
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        if (uniform_rp && k == 0) {
+            fprintf(stdout, "Replacement Policy:    %s\n", replacement_policy_map[level->rp]);
+        } else if (!uniform_rp) {
+            snprintf(label, sizeof(label), "%s Replacement Policy:", level->name);
+            fprintf(stdout, "%-23s%s\n", label, replacement_policy_map[level->rp]);
+        }
+    }
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        if (uniform_wp && k == 0) {
+            fprintf(stdout, "Write Policy:          %s\n", write_policy_map[level->wp]);
+        } else if (!uniform_wp) {
+            snprintf(label, sizeof(label), "%s Write Policy:", level->name);
+            fprintf(stdout, "%-23s%s\n", label, write_policy_map[level->wp]);
+        }
+    }
+    for (uint64_t k = 1; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        if (level->inclusion != NINE) {
+            snprintf(label, sizeof(label), "%s Inclusion Policy:", level->name);
+            fprintf(stdout, "%-23s%s\n", label, inclusion_policy_map[level->inclusion]);
+        }
+        if (level->hit_time > 0) {
+            snprintf(label, sizeof(label), "%s Hit Time:", level->name);
+            fprintf(stdout, "%-23s%.2f\n", label, level->hit_time);
+        }
+    }
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        for (int side = level->split ? 0 : 1; side < 2; side++) {
+            const struct cache_config_t *cache = side == 0 ? &level->inst : &level->data;
+            cache_name(name, sizeof(name), level, side);
+            if (cache->pf != NO_PREFETCH) {
+                fprintf(stdout, "%s Prefetcher: %s (Degree=%" PRIu64 ", Distance=%" PRIu64 ")\n", name,
+                        prefetch_policy_map[cache->pf], cache->pf_degree, cache->pf_distance);
+            }
+            if (cache->vc_entries) {
+                fprintf(stdout, "%s Victim Cache: (Entries=%" PRIu64 ", Hit Time=%" PRIu64 ")\n", name,
+                        cache->vc_entries, cache->vc_hit_time);
+            }
+            if (cache->wb_entries) {
+                fprintf(stdout, "%s Write Buffer: (Entries=%" PRIu64 ")\n", name, cache->wb_entries);
+            }
+            if (cache->banks > 1) {
+                fprintf(stdout, "%s Banks: (Count=%" PRIu64 ", Select Bit=%" PRIu64 ", Busy=%" PRIu64 ", Queue=%" PRIu64 ")\n", name,
+                        cache->banks, cache->bank_bit ? cache->bank_bit : cache->b, cache->bank_busy, cache->bank_queue);
+            }
+            if (cache->indexing != BIT_SLICE) {
+                fprintf(stdout, "%s Indexing: %s\n", name, index_policy_map[cache->indexing]);
+            }
+            if (cache->insertion != INSERT_MRU) {
+                fprintf(stdout, "%s Insertion: %s\n", name, insertion_policy_map[cache->insertion]);
+            }
+            if (cache->bypass) {
+                fprintf(stdout, "%s Bypass: Dead Block Predictor\n", name);
+            }
+            if (cache->way_pred != NO_WAY_PREDICTION) {
+                struct cache_config_t dm = *cache;
+                dm.s = 0;
+                double fast = cache->fast_hit_time ? (double)cache->fast_hit_time : level_hit_time(level, &dm);
+                fprintf(stdout, "%s Way Prediction: %s (Fast Hit Time=%.2f, Mispredict Penalty=%" PRIu64 ")\n", name,
+                        way_prediction_map[cache->way_pred], fast, cache->mispredict_penalty);
+            }
+            if (cache->class_ways[0] || cache->class_ways[1] || cache->class_ways[2]) {
+                fprintf(stdout, "%s Way Partition: (I=0x%" PRIx64 ", L=0x%" PRIx64 ", S=0x%" PRIx64 ")\n", name,
+                        cache->class_ways[0], cache->class_ways[1], cache->class_ways[2]);
+            }
+            for (uint64_t core = 0; core < sim_conf->cores; core++) {
+                if (cache->core_ways[core]) {
+                    fprintf(stdout, "%s Core %" PRIu64 " Ways: 0x%" PRIx64 "\n", name, core, cache->core_ways[core]);
+                }
+            }
+        }
+    }
+    if (sim_conf->vm.page) {
+        const struct tlb_config_t *tlbs[] = {&sim_conf->vm.itlb, &sim_conf->vm.dtlb, &sim_conf->vm.stlb};
+        const char *names[] = {"ITLB:", "DTLB:", "L2 TLB:"};
+        fprintf(stdout, "Page Size:             %s\n", page_size_map[sim_conf->vm.page]);
+        for (int i = 0; i < 3; i++) {
+            if (tlbs[i]->entries) {
+                fprintf(stdout, "%-23s(Entries=%" PRIu64 ", S=%" PRIu64 ", Hit Time=%.2f)\n", names[i],
+                        tlbs[i]->entries, tlbs[i]->s, tlbs[i]->hit_time);
+            }
+        }
+    }
+    if (sim_conf->mem.model == MEM_DRAM) {
+        fprintf(stdout, "Main Memory:           DRAM (Channels=%" PRIu64 ", Banks=%" PRIu64 ", Row Size=%" PRIu64 ", Mapping=%s)\n",
+                sim_conf->mem.channels, sim_conf->mem.banks, sim_conf->mem.row_size, dram_mapping_map[sim_conf->mem.mapping]);
+        fprintf(stdout, "DRAM Timing:           (Hit=%" PRIu64 ", Miss=%" PRIu64 ", Conflict=%" PRIu64 ", Bus=%" PRIu64 ", Queue=%" PRIu64 ", Issue Interval=%" PRIu64 ")\n",
+                sim_conf->mem.row_hit_time, sim_conf->mem.row_miss_time, sim_conf->mem.row_conflict_time,
+                sim_conf->mem.bus_time, sim_conf->mem.queue_depth, sim_conf->issue_interval);
+    }
+    if (sim_conf->classify_misses) {
+        fprintf(stdout, "Miss Classification:   Compulsory/Capacity/Conflict\n");
+    }
+    if (sim_conf->latency_histogram) {
+        fprintf(stdout, "Latency Histogram:     p50/p90/p99/p99.9\n");
+    }
+    if (sim_conf->analysis.file[0]) {
+        fprintf(stdout, "Analysis:              %s (Format=%s, Top Misses=%" PRIu64 ")\n", sim_conf->analysis.file,
+                output_format_map[sim_conf->analysis.format], sim_conf->analysis.top_misses);
+    }
+    if (sim_conf->timeseries.file[0]) {
+        fprintf(stdout, "Time Series:           %s (Format=%s, Window=%" PRIu64 " %s)\n", sim_conf->timeseries.file,
+                output_format_map[sim_conf->timeseries.format], sim_conf->timeseries.interval,
+                sim_conf->timeseries.cycles ? "Cycles" : "Accesses");
+    }
+    if (sim_conf->event_log[0]) {
+        fprintf(stdout, "Event Log:             %s\n", sim_conf->event_log);
+    }
+    if (has_region(sim_conf)) {
+        fprintf(stdout, "Region:                Skip=%" PRIu64 ", Warm Up=%" PRIu64 ", Accesses=", sim_conf->region.skip, sim_conf->region.warm_up);
+        if (sim_conf->region.accesses) {
+            fprintf(stdout, "%" PRIu64, sim_conf->region.accesses);
+        } else {
+            fprintf(stdout, "Rest of Trace");
+        }
+        fprintf(stdout, ", Segments=%" PRIu64 "\n", sim_conf->region.segments);
+    }
+    if (sim_conf->generator.pattern) {
+        const struct generator_config_t *gen = &sim_conf->generator;
+        fprintf(stdout, "Generator:             %s (Accesses=%" PRIu64 ", Seed=%" PRIu64 ", Working Set=%" PRIu64,
+                generator_pattern_map[gen->pattern], gen->accesses, gen->seed, gen->working_set);
+        if (gen->pattern == GEN_STRIDED) {
+            fprintf(stdout, ", Stride=%" PRIu64, gen->stride);
+        } else if (gen->pattern == GEN_ZIPF) {
+            fprintf(stdout, ", Zipf Exponent=%.2f", gen->zipf_exponent);
+        }
+        fprintf(stdout, ", Mix=%" PRIu64 "/%" PRIu64 "/%" PRIu64 ")\n", gen->mix[0], gen->mix[1], gen->mix[2]);
+    }
+    if (sim_conf->checkpoint.restore[0]) {
+        fprintf(stdout, "Restore Checkpoint:    %s\n", sim_conf->checkpoint.restore);
+    }
+    if (sim_conf->checkpoint.save[0] && sim_conf->checkpoint.at) {
+        fprintf(stdout, "Save Checkpoint:       %s (At=%" PRIu64 " Accesses)\n", sim_conf->checkpoint.save, sim_conf->checkpoint.at);
+    } else if (sim_conf->checkpoint.save[0]) {
+        fprintf(stdout, "Save Checkpoint:       %s (At=End of Trace)\n", sim_conf->checkpoint.save);
+    }
+}
+
+// Helpers to print one statistic of a cache, lined up with the rest of the output
+static void print_count(const char *name, const char *stat, uint64_t value)
+{
+    char label[128];
+    snprintf(label, sizeof(label), "%s %s", name, stat);
+    printf("%-35s %" PRIu64 "\n", label, value);
+}
+static void print_value(const char *name, const char *stat, double value)
+{
+    char label[128];
+    snprintf(label, sizeof(label), "%s %s", name, stat);
+    printf("%-35s %.8f\n", label, value);
 }
 
-static void print_sim_output(struct sim_stats_t *sim_stats)
+static void print_sim_output(struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
 {
     printf("\nSIMULATION OUTPUT\n");
 
-    // L1 Instruction Stats
-    printf("L1 Instruction Accesses             %" PRIu64 "\n", sim_stats->l1inst_num_accesses);
-    printf("L1 Instruction Misses               %" PRIu64 "\n", sim_stats->l1inst_num_misses);
-    printf("L1 Instruction Evictions            %" PRIu64 "\n", sim_stats->l1inst_num_evictions);
-    printf("L1 Instruction Hit Time             %.8f\n", sim_stats->l1inst_hit_time);
-    printf("L1 Instruction Miss Penalty         %.8f\n", sim_stats->l1inst_miss_penalty);
-    printf("L1 Instruction Miss Rate            %.8f\n", sim_stats->l1inst_miss_rate);
-    printf("L1 Instruction Avg Access Time      %.8f\n", sim_stats->l1inst_AAT);
-
-    // L1 Data Stats
-    printf("L1 Data Accesses                    %" PRIu64 "\n", sim_stats->l1data_num_accesses);
-    printf("L1 Data Load Accesses               %" PRIu64 "\n", sim_stats->l1data_num_accesses_loads);
-    printf("L1 Data Store Accesses              %" PRIu64 "\n", sim_stats->l1data_num_accesses_stores);
-    printf("L1 Data Misses                      %" PRIu64 "\n", sim_stats->l1data_num_misses);
-    printf("L1 Data Load Misses                 %" PRIu64 "\n", sim_stats->l1data_num_misses_loads);
-    printf("L1 Data Store Misses                %" PRIu64 "\n", sim_stats->l1data_num_misses_stores);
-    printf("L1 Data Evictions                   %" PRIu64 "\n", sim_stats->l1data_num_evictions);
-    printf("L1 Data Hit Time                    %.8f\n", sim_stats->l1data_hit_time);
-    printf("L1 Data Miss Penalty                %.8f\n", sim_stats->l1data_miss_penalty);
-    printf("L1 Data Miss Rate                   %.8f\n", sim_stats->l1data_miss_rate);
-    printf("L1 Data Avg Access Time             %.8f\n", sim_stats->l1data_AAT);
-
-    // L2 Stats
-    printf("L2 Accesses                         %" PRIu64 "\n", sim_stats->l2unified_num_accesses);
-    printf("L2 Instruction Accesses             %" PRIu64 "\n", sim_stats->l2unified_num_accesses_insts);
-    printf("L2 Load Accesses                    %" PRIu64 "\n", sim_stats->l2unified_num_accesses_loads);
-    printf("L2 Store Accesses                   %" PRIu64 "\n", sim_stats->l2unified_num_accesses_stores);
-    printf("L2 Misses                           %" PRIu64 "\n", sim_stats->l2unified_num_misses);
-    printf("L2 Instruction Misses               %" PRIu64 "\n", sim_stats->l2unified_num_misses_insts);
-    printf("L2 Load Misses                      %" PRIu64 "\n", sim_stats->l2unified_num_misses_loads);
-    printf("L2 Store Misses                     %" PRIu64 "\n", sim_stats->l2unified_num_misses_stores);
-    printf("L2 Evictions                        %" PRIu64 "\n", sim_stats->l2unified_num_evictions);
-    printf("L2 Write Backs                      %" PRIu64 "\n", sim_stats->l2unified_num_write_backs);
-    printf("L2 Bytes Transferred                %" PRIu64 "\n", sim_stats->l2unified_num_bytes_transferred);
-    printf("L2 Hit Time                         %.8f\n", sim_stats->l2unified_hit_time);
-    printf("L2 Miss Penalty                     %.8f\n", sim_stats->l2unified_miss_penalty);
-    printf("L2 Miss Rate                        %.8f\n", sim_stats->l2unified_miss_rate);
-    printf("L2 Avg Access Time                  %.8f\n", sim_stats->l2unified_AAT);
+    // Cache Stats, the type breakdown only for caches that see more than one type
+    for (uint64_t i = 0; i < sim_stats->num_caches; i++) {
+        const struct cache_stats_t *stats = &sim_stats->caches[i];
+        bool breakdown = stats->data;
+        print_count(stats->name, "Accesses", stats->num_accesses);
+        if (breakdown && stats->insts) {
+            print_count(stats->name, "Instruction Accesses", stats->num_accesses_insts);
+        }
+        if (breakdown) {
+            print_count(stats->name, "Load Accesses", stats->num_accesses_loads);
+            print_count(stats->name, "Store Accesses", stats->num_accesses_stores);
+        }
+        print_count(stats->name, "Misses", stats->num_misses);
+        if (breakdown && stats->insts) {
+            print_count(stats->name, "Instruction Misses", stats->num_misses_insts);
+        }
+        if (breakdown) {
+            print_count(stats->name, "Load Misses", stats->num_misses_loads);
+            print_count(stats->name, "Store Misses", stats->num_misses_stores);
+        }
+        if (sim_conf->levels[stats->level].data.sectors > 1 || sim_conf->levels[stats->level].inst.sectors > 1) {
+            print_count(stats->name, "Sector Misses", stats->num_sector_misses);
+        }
+        if (sim_conf->classify_misses) {
+            const char *classes[] = {"Compulsory", "Capacity", "Conflict"};
+            const char *types[] = {"Instruction", "Load", "Store"};
+            char label[64];
+            for (int j = 0; j < 3; j++) {
+                const uint64_t *by_type = stats->num_class_misses[j];
+                snprintf(label, sizeof(label), "%s Misses", classes[j]);
+                print_count(stats->name, label, by_type[0] + by_type[1] + by_type[2]);
+                for (int type = breakdown ? (stats->insts ? 0 : 1) : 3; type < 3; type++) {
+                    snprintf(label, sizeof(label), "%s %s", types[type], classes[j]);
+                    print_count(stats->name, label, by_type[type]);
+                }
+            }
+        }
+        const struct cache_config_t *cache = stats->data ? &sim_conf->levels[stats->level].data : &sim_conf->levels[stats->level].inst;
+        if (cache->indexing != BIT_SLICE) {
+            print_count(stats->name, "Bit Slice Misses", stats->num_bit_slice_misses);
+            print_value(stats->name, "Conflict Miss Reduction", stats->conflict_miss_reduction);
+        }
+        print_count(stats->name, "Evictions", stats->num_evictions);
+        if (stats->level > 0) {
+            print_count(stats->name, "Write Backs", stats->num_write_backs);
+            print_count(stats->name, "Bytes Transferred", stats->num_bytes_transferred);
+        }
+        print_value(stats->name, "Hit Time", stats->hit_time);
+        print_value(stats->name, "Miss Penalty", stats->miss_penalty);
+        print_value(stats->name, "Miss Rate", stats->miss_rate);
+        print_value(stats->name, "Avg Access Time", stats->AAT);
+    }
+
+    // Translation Stats
+    if (sim_conf->vm.page) {
+        const struct tlb_stats_t *tlbs[] = {&sim_stats->itlb, &sim_stats->dtlb, &sim_stats->stlb};
+        const char *names[] = {"ITLB", "DTLB", "L2 TLB"};
+        for (int i = 0; i < 3; i++) {
+            if (i == 2 && sim_conf->vm.stlb.entries == 0) {
+                continue;
+            }
+            print_count(names[i], "Accesses", tlbs[i]->num_accesses);
+            print_count(names[i], "Misses", tlbs[i]->num_misses);
+            print_value(names[i], "Hit Time", tlbs[i]->hit_time);
+            print_value(names[i], "Miss Rate", tlbs[i]->miss_rate);
+        }
+        printf("Page Walks                          %" PRIu64 "\n", sim_stats->num_page_walks);
+        printf("Page Walk Loads                     %" PRIu64 "\n", sim_stats->num_walk_accesses);
+        printf("Avg Page Walk Time                  %.8f\n", sim_stats->avg_walk_time);
+        printf("Instruction Translation Time        %.8f\n", sim_stats->inst_translation_time);
+        printf("Data Translation Time               %.8f\n", sim_stats->data_translation_time);
+    }
 
     // Performance Statistics
     printf("Instruction Avg Access Time         %.8f\n", sim_stats->inst_avg_access_time);
     printf("Data (Load/Store) Avg Access Time   %.8f\n", sim_stats->data_avg_access_time);
     printf("Overall Average Access Time         %.8f\n", sim_stats->avg_access_time);
+
+    // Latency Percentiles
+    if (sim_conf->latency_histogram) {
+        const char *types[] = {"Instruction", "Load", "Store"};
+        const char *percents[] = {"p50", "p90", "p99", "p99.9"};
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4 && sim_stats->latency[i].total; j++) {
+                char label[64];
+                snprintf(label, sizeof(label), "%s Latency %s", types[i], percents[j]);
+                printf("%-35s %" PRIu64 "\n", label, sim_stats->latency[i].percentiles[j]);
+            }
+        }
+    }
+
+    // Access Size Stats
+    if (sim_stats->num_sized_accesses) {
+        printf("Sized Accesses                      %" PRIu64 "\n", sim_stats->num_sized_accesses);
+        printf("Split Accesses                      %" PRIu64 "\n", sim_stats->num_split_accesses);
+    }
+
+    // Core and Coherence Stats
+    if (sim_conf->cores > 1) {
+        uint64_t invalidations = 0;
+        uint64_t upgrades = 0;
+        uint64_t transfers = 0;
+        for (uint64_t core = 0; core < sim_conf->cores; core++) {
+            const struct core_stats_t *stats = &sim_stats->cores[core];
+            char name[16];
+            snprintf(name, sizeof(name), "Core %" PRIu64, core);
+            print_count(name, "Accesses", stats->num_accesses);
+            print_value(name, "Avg Access Time", stats->avg_access_time);
+            print_count(name, "Invalidations", stats->num_invalidations);
+            print_count(name, "Upgrades", stats->num_upgrades);
+            print_count(name, "C2C Transfers", stats->num_c2c_transfers);
+            invalidations += stats->num_invalidations;
+            upgrades += stats->num_upgrades;
+            transfers += stats->num_c2c_transfers;
+        }
+        printf("Coherence Invalidations             %" PRIu64 "\n", invalidations);
+        printf("Coherence Upgrades                  %" PRIu64 "\n", upgrades);
+        printf("Cache-to-Cache Transfers            %" PRIu64 "\n", transfers);
+    }
+
+    // Inclusion Stats
+    bool inclusion = false;
+    for (uint64_t k = 1; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        if (level->inclusion == NINE) {
+            continue;
+        }
+        inclusion = true;
+        for (uint64_t i = 0; i < sim_stats->num_caches; i++) {
+            const struct cache_stats_t *stats = &sim_stats->caches[i];
+            if (stats->level == k) {
+                print_count(stats->name, "Back Invalidations", stats->num_back_invalidations);
+                print_count(stats->name, "Back Inval Write Backs", stats->num_back_invalidation_write_backs);
+            }
+        }
+    }
+    if (inclusion) {
+        printf("Effective Capacity                  %" PRIu64 "\n", sim_stats->effective_capacity);
+        printf("Effective Capacity Gain             %.8f\n", sim_stats->effective_capacity_gain);
+    }
+
+    // Victim Cache and Prefetcher Stats
+    bool prefetching = false;
+    for (uint64_t i = 0; i < sim_stats->num_caches; i++) {
+        const struct cache_stats_t *stats = &sim_stats->caches[i];
+        const struct level_config_t *level = &sim_conf->levels[stats->level];
+        const struct cache_config_t *cache = stats->data ? &level->data : &level->inst;
+        if (cache->vc_entries) {
+            print_count(stats->name, "Victim Accesses", stats->victim.num_accesses);
+            print_count(stats->name, "Victim Hits", stats->victim.num_hits);
+            print_count(stats->name, "Victim Evictions", stats->victim.num_evictions);
+            print_count(stats->name, "Victim Write Backs", stats->victim.num_write_backs);
+            print_value(stats->name, "Victim Hit Time", stats->victim.hit_time);
+            print_value(stats->name, "Victim Miss Rate", stats->victim.miss_rate);
+        }
+        if (cache->wb_entries) {
+            print_count(stats->name, "Write Buffer Writes", stats->write_buffer.num_writes);
+            print_count(stats->name, "Write Buffer Merges", stats->write_buffer.num_merges);
+            print_count(stats->name, "Write Buffer Full Stalls", stats->write_buffer.num_full_stalls);
+            print_count(stats->name, "Write Buffer Stall Cycles", stats->write_buffer.num_stall_cycles);
+            print_count(stats->name, "Write Buffer Drains", stats->write_buffer.num_drains);
+            print_count(stats->name, "Write Buffer Bytes Drained", stats->write_buffer.num_bytes_drained);
+            print_value(stats->name, "Write Buffer Merge Rate", stats->write_buffer.merge_rate);
+            print_value(stats->name, "Write Buffer Traffic Saved", stats->write_buffer.traffic_reduction);
+        }
+        if (cache->banks > 1) {
+            print_count(stats->name, "Bank Conflicts", stats->num_bank_conflicts);
+            print_count(stats->name, "Bank Conflict Cycles", stats->num_bank_conflict_cycles);
+            print_count(stats->name, "Bank Queue Stalls", stats->num_bank_queue_stalls);
+            for (uint64_t j = 0; j < cache->banks; j++) {
+                char bank[32];
+                snprintf(bank, sizeof(bank), "Bank %" PRIu64 " Utilization", j);
+                print_value(stats->name, bank, stats->bank_utilization[j]);
+            }
+        }
+        if (cache->way_pred != NO_WAY_PREDICTION) {
+            print_count(stats->name, "Way Predicted Hits", stats->num_way_hits);
+            print_count(stats->name, "Way Mispredictions", stats->num_way_mispredictions);
+            print_value(stats->name, "Way Pred Accuracy", stats->way_prediction_accuracy);
+        }
+        if (cache->bypass) {
+            print_count(stats->name, "Bypasses", stats->num_bypasses);
+            print_count(stats->name, "Dead Evictions", stats->num_dead_evictions);
+            print_value(stats->name, "Predictor Accuracy", stats->predictor_accuracy);
+        }
+        bool by_class = cache->class_ways[0] || cache->class_ways[1] || cache->class_ways[2];
+        bool by_core = false;
+        for (uint64_t core = 0; core < sim_conf->cores; core++) {
+            by_core = by_core || cache->core_ways[core];
+        }
+        if (by_class || by_core) {
+            print_value(stats->name, "Instruction Occupancy", stats->class_occupancy[0]);
+            print_value(stats->name, "Load Occupancy", stats->class_occupancy[1]);
+            print_value(stats->name, "Store Occupancy", stats->class_occupancy[2]);
+        }
+        for (uint64_t core = 0; by_core && core < sim_conf->cores; core++) {
+            char label[32];
+            snprintf(label, sizeof(label), "Core %" PRIu64 " Misses", core);
+            print_count(stats->name, label, stats->num_core_misses[core]);
+            snprintf(label, sizeof(label), "Core %" PRIu64 " Occupancy", core);
+            print_value(stats->name, label, stats->core_occupancy[core]);
+        }
+        if (cache->pf != NO_PREFETCH) {
+            prefetching = true;
+            print_count(stats->name, "Prefetches Issued", stats->prefetch.num_issued);
+            print_count(stats->name, "Prefetches Useful", stats->prefetch.num_useful);
+            print_count(stats->name, "Prefetches Late", stats->prefetch.num_late);
+            print_count(stats->name, "Prefetches Polluting", stats->prefetch.num_polluting);
+        }
+    }
+    if (prefetching) {
+        printf("Prefetch AAT Change                 %.8f\n", sim_stats->prefetch_AAT_change);
+    }
+
+    // Main Memory Stats
+    if (sim_conf->mem.model == MEM_DRAM) {
+        printf("DRAM Reads                          %" PRIu64 "\n", sim_stats->mem_num_reads);
+        printf("DRAM Writes                         %" PRIu64 "\n", sim_stats->mem_num_writes);
+        printf("DRAM Row Hits                       %" PRIu64 "\n", sim_stats->mem_num_row_hits);
+        printf("DRAM Row Misses                     %" PRIu64 "\n", sim_stats->mem_num_row_misses);
+        printf("DRAM Row Conflicts                  %" PRIu64 "\n", sim_stats->mem_num_row_conflicts);
+        printf("DRAM Queue Full Stalls              %" PRIu64 "\n", sim_stats->mem_num_queue_stalls);
+        printf("DRAM Row Buffer Hit Rate            %.8f\n", sim_stats->mem_row_hit_rate);
+        printf("DRAM Avg Read Latency               %.8f\n", sim_stats->mem_avg_read_latency);
+        printf("DRAM Avg Queueing Delay             %.8f\n", sim_stats->mem_avg_queue_delay);
+    }
 }
 
 // Helper to compare json token strings
@@ -113,22 +505,443 @@ static int jsoneq(const char *json, jsmntok_t *tok, const char *s)
   return -1;
 }
 
-// Helper to parse a cache configuration -- does not check for error
-static void parse_cache(const char *buffer, jsmntok_t *t, int index, struct cache_config_t *cache)
+// Helper to find the token following a value and all of its children
+static int json_next(jsmntok_t *t, int index, int r)
+{
+    int end = t[index].end;
+    for (index++; index < r && t[index].start < end; index++);
+    return index;
+}
+
+// Helper to read an unsigned number from a primitive token
+static uint64_t json_uint(const char *buffer, jsmntok_t *tok)
 {
     char *ptr;
-    if (jsoneq(buffer, &t[index], "C") == 0 && t[index + 1].type == JSMN_PRIMITIVE) {
-        cache->c = (uint64_t) strtol(buffer + t[index + 1].start, &ptr, 10);
-        index += 2;
+    return (uint64_t) strtoull(buffer + tok->start, &ptr, 10);
+}
+
+// Helper to parse the main memory configuration -- does not check for error
+static void parse_memory(const char *buffer, jsmntok_t *t, int index, int r, struct mem_config_t *mem)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Model") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("DRAM", buffer + v->start, 4) == 0) {
+                mem->model = MEM_DRAM;
+            } else {
+                mem->model = MEM_FIXED; // Default is the flat miss penalty
+            }
+        } else if (jsoneq(buffer, &t[i], "Mapping") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("RoCoBaCh", buffer + v->start, 8) == 0) {
+                mem->mapping = RO_CO_BA_CH;
+            } else if (strncmp("XOR", buffer + v->start, 3) == 0) {
+                mem->mapping = RO_BA_CH_CO_XOR;
+            } else {
+                mem->mapping = RO_BA_CH_CO; // Default keeps consecutive blocks in one row
+            }
+        } else if (v->type == JSMN_PRIMITIVE) {
+            if (jsoneq(buffer, &t[i], "Channels") == 0) {
+                mem->channels = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Banks") == 0) {
+                mem->banks = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Row Size") == 0) {
+                mem->row_size = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Row Hit Time") == 0) {
+                mem->row_hit_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Row Miss Time") == 0) {
+                mem->row_miss_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Row Conflict Time") == 0) {
+                mem->row_conflict_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Bus Time") == 0) {
+                mem->bus_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Queue Depth") == 0) {
+                mem->queue_depth = json_uint(buffer, v);
+            }
+        }
+    }
+}
+
+// Helper to parse a TLB configuration -- does not check for error
+static void parse_tlb(const char *buffer, jsmntok_t *t, int index, int r, struct tlb_config_t *tlb)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (v->type == JSMN_PRIMITIVE) {
+            if (jsoneq(buffer, &t[i], "Entries") == 0) {
+                tlb->entries = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "S") == 0) {
+                tlb->s = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Hit Time") == 0) {
+                tlb->hit_time = strtod(buffer + v->start, NULL);
+            }
+        }
+    }
+}
+
+// Helper to parse the virtual memory configuration -- does not check for error
+// Giving one turns translation on, every TLB left out keeps its default
+static void parse_vm(const char *buffer, jsmntok_t *t, int index, int r, struct vm_config_t *vm)
+{
+    vm->page = PAGE_4K;
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Page Size") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("2M", buffer + v->start, 2) == 0) {
+                vm->page = PAGE_2M;
+            } else if (strncmp("1G", buffer + v->start, 2) == 0) {
+                vm->page = PAGE_1G;
+            } else {
+                vm->page = PAGE_4K; // Default is the base page size
+            }
+        } else if (jsoneq(buffer, &t[i], "ITLB") == 0 && v->type == JSMN_OBJECT) {
+            parse_tlb(buffer, t, i + 1, r, &vm->itlb);
+        } else if (jsoneq(buffer, &t[i], "DTLB") == 0 && v->type == JSMN_OBJECT) {
+            parse_tlb(buffer, t, i + 1, r, &vm->dtlb);
+        } else if (jsoneq(buffer, &t[i], "L2 TLB") == 0 && v->type == JSMN_OBJECT) {
+            parse_tlb(buffer, t, i + 1, r, &vm->stlb);
+        }
+    }
+}
+
+// Helper to parse the way masks of a partitioned cache, "I", "L" and "S" for the
+// access classes and "Cores" for one mask per core, as numbers or "0x" strings
+static void parse_partition(const char *buffer, jsmntok_t *t, int index, int r, struct cache_config_t *cache)
+{
+    const char *classes[] = {"I", "L", "S"};
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        for (int j = 0; j < 3; j++) {
+            if (jsoneq(buffer, &t[i], classes[j]) == 0) {
+                cache->class_ways[j] = strtoull(buffer + v->start, NULL, 0);
+            }
+        }
+        if (jsoneq(buffer, &t[i], "Cores") == 0 && v->type == JSMN_ARRAY) {
+            uint64_t core = 0;
+            int cores_end = json_next(t, i + 1, r);
+            for (int j = i + 2; j < cores_end && core < MAX_CORES; j = json_next(t, j, r)) {
+                cache->core_ways[core++] = strtoull(buffer + t[j].start, NULL, 0);
+            }
+        }
+    }
+}
+
+// Helper to parse where the per-cache distributions go -- does not check for error
+static void parse_analysis(const char *buffer, jsmntok_t *t, int index, int r, struct analysis_config_t *analysis)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "File") == 0 && v->type == JSMN_STRING) {
+            int len = v->end - v->start;
+            if (len >= (int)sizeof(analysis->file)) {
+                print_err_usage("Analysis file name too long");
+            }
+            memcpy(analysis->file, buffer + v->start, len);
+            analysis->file[len] = '\0';
+        } else if (jsoneq(buffer, &t[i], "Format") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("Binary", buffer + v->start, 6) == 0) {
+                analysis->format = OUTPUT_BINARY;
+            } else {
+                analysis->format = OUTPUT_CSV; // Default is one CSV row per record
+            }
+        } else if (jsoneq(buffer, &t[i], "Top Misses") == 0 && v->type == JSMN_PRIMITIVE) {
+            analysis->top_misses = json_uint(buffer, v);
+        }
+    }
+}
+
+// Helper to parse the windows of the time series -- does not check for error
+static void parse_timeseries(const char *buffer, jsmntok_t *t, int index, int r, struct timeseries_config_t *timeseries)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "File") == 0 && v->type == JSMN_STRING) {
+            int len = v->end - v->start;
+            if (len >= (int)sizeof(timeseries->file)) {
+                print_err_usage("Time Series file name too long");
+            }
+            memcpy(timeseries->file, buffer + v->start, len);
+            timeseries->file[len] = '\0';
+        } else if (jsoneq(buffer, &t[i], "Format") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("Binary", buffer + v->start, 6) == 0) {
+                timeseries->format = OUTPUT_BINARY;
+            } else {
+                timeseries->format = OUTPUT_CSV; // Default is one CSV row per window and cache
+            }
+        } else if (jsoneq(buffer, &t[i], "Accesses") == 0 && v->type == JSMN_PRIMITIVE) {
+            timeseries->interval = json_uint(buffer, v);
+            timeseries->cycles = false;
+        } else if (jsoneq(buffer, &t[i], "Cycles") == 0 && v->type == JSMN_PRIMITIVE) {
+            timeseries->interval = json_uint(buffer, v);
+            timeseries->cycles = true;
+        }
     }
+}
 
-    if (jsoneq(buffer, &t[index], "B") == 0 && t[index + 1].type == JSMN_PRIMITIVE) {
-        cache->b = (uint64_t) strtol(buffer + t[index + 1].start, &ptr, 10);
-        index += 2;
+// Helper to parse where a checkpoint is saved or restored from -- does not check for error
+static void parse_checkpoint(const char *buffer, jsmntok_t *t, int index, int r, struct checkpoint_config_t *checkpoint)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        int len = v->end - v->start;
+        if (jsoneq(buffer, &t[i], "Save") == 0 && v->type == JSMN_STRING) {
+            if (len >= (int)sizeof(checkpoint->save)) {
+                print_err_usage("Checkpoint file name too long");
+            }
+            memcpy(checkpoint->save, buffer + v->start, len);
+            checkpoint->save[len] = '\0';
+        } else if (jsoneq(buffer, &t[i], "Restore") == 0 && v->type == JSMN_STRING) {
+            if (len >= (int)sizeof(checkpoint->restore)) {
+                print_err_usage("Checkpoint file name too long");
+            }
+            memcpy(checkpoint->restore, buffer + v->start, len);
+            checkpoint->restore[len] = '\0';
+        } else if (jsoneq(buffer, &t[i], "At") == 0) {
+            checkpoint->at = json_uint(buffer, v);
+        }
     }
+}
 
-    if (jsoneq(buffer, &t[index], "S") == 0 && t[index + 1].type == JSMN_PRIMITIVE) {
-        cache->s = (uint64_t) strtol(buffer + t[index + 1].start, &ptr, 10);
+// Helper to parse the region of the trace a run simulates -- does not check for error
+static void parse_region(const char *buffer, jsmntok_t *t, int index, int r, struct region_config_t *region)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Skip") == 0) {
+            region->skip = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Warm Up") == 0) {
+            region->warm_up = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Accesses") == 0) {
+            region->accesses = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Segments") == 0) {
+            region->segments = json_uint(buffer, v);
+        }
+    }
+}
+
+// Helper to parse the synthetic accesses of a run -- does not check for error
+static void parse_generator(const char *buffer, jsmntok_t *t, int index, int r, struct generator_config_t *gen)
+{
+    static const char *const patterns[] = {"Sequential", "Strided", "Uniform", "Zipf", "Pointer Chase"};
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Pattern") == 0 && v->type == JSMN_STRING) {
+            for (int p = 0; p < 5; p++) {
+                if (jsoneq(buffer, v, patterns[p]) == 0) {
+                    gen->pattern = (enum generator_pattern)(p + 1);
+                }
+            }
+            if (!gen->pattern) {
+                print_err_usage("Pattern must be Sequential, Strided, Uniform, Zipf or Pointer Chase");
+            }
+        } else if (jsoneq(buffer, &t[i], "Accesses") == 0) {
+            gen->accesses = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Seed") == 0) {
+            gen->seed = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Working Set") == 0) {
+            gen->working_set = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Stride") == 0) {
+            gen->stride = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Zipf Exponent") == 0) {
+            gen->zipf_exponent = strtod(buffer + v->start, NULL);
+        } else if (jsoneq(buffer, &t[i], "Access Size") == 0) {
+            gen->size = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Code Size") == 0) {
+            gen->code_size = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Mix") == 0) {
+            // Weights of Instructions, Loads and Stores
+            if (v->type != JSMN_ARRAY || v->size != 3) {
+                print_err_usage("Mix must be an array of 3 weights for Instructions, Loads and Stores");
+            }
+            for (int k = 0; k < 3; k++) {
+                gen->mix[k] = json_uint(buffer, &t[i + 2 + k]);
+            }
+        }
+    }
+}
+
+// Helper to parse a cache configuration -- does not check for error
+static void parse_cache(const char *buffer, jsmntok_t *t, int index, int r, struct cache_config_t *cache)
+{
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Way Partition") == 0 && v->type == JSMN_OBJECT) {
+            parse_partition(buffer, t, i + 1, r, cache);
+        } else if (jsoneq(buffer, &t[i], "Insertion") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("LIP", buffer + v->start, 3) == 0) {
+                cache->insertion = INSERT_LIP;
+            } else if (strncmp("BIP", buffer + v->start, 3) == 0) {
+                cache->insertion = INSERT_BIP;
+            } else {
+                cache->insertion = INSERT_MRU; // Default is the most recently used position
+            }
+        } else if (jsoneq(buffer, &t[i], "Bypass") == 0 && v->type == JSMN_PRIMITIVE) {
+            cache->bypass = buffer[v->start] == 't';
+        } else if (jsoneq(buffer, &t[i], "Way Prediction") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("MRU", buffer + v->start, 3) == 0) {
+                cache->way_pred = WAY_PREDICT_MRU;
+            } else if (strncmp("Table", buffer + v->start, 5) == 0) {
+                cache->way_pred = WAY_PREDICT_TABLE;
+            } else {
+                cache->way_pred = NO_WAY_PREDICTION; // Default is probing every way at once
+            }
+        } else if (jsoneq(buffer, &t[i], "Indexing") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("XOR", buffer + v->start, 3) == 0) {
+                cache->indexing = XOR_INDEX;
+            } else if (strncmp("Skewed", buffer + v->start, 6) == 0) {
+                cache->indexing = SKEWED;
+            } else {
+                cache->indexing = BIT_SLICE; // Default is the plain index bits
+            }
+        } else if (jsoneq(buffer, &t[i], "Prefetcher") == 0 && v->type == JSMN_STRING) {
+            if (strncmp("Next Line", buffer + v->start, 9) == 0) {
+                cache->pf = NEXT_LINE;
+            } else if (strncmp("Stride", buffer + v->start, 6) == 0) {
+                cache->pf = STRIDE;
+            } else if (strncmp("Stream", buffer + v->start, 6) == 0) {
+                cache->pf = STREAM_BUFFER;
+            } else {
+                cache->pf = NO_PREFETCH; // Default is demand fetching only
+            }
+        } else if (v->type == JSMN_PRIMITIVE) {
+            if (jsoneq(buffer, &t[i], "C") == 0) {
+                cache->c = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "B") == 0) {
+                cache->b = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "S") == 0) {
+                cache->s = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Sectors") == 0) {
+                cache->sectors = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Prefetch Degree") == 0) {
+                cache->pf_degree = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Prefetch Distance") == 0) {
+                cache->pf_distance = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Victim Cache") == 0) {
+                cache->vc_entries = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Victim Hit Time") == 0) {
+                cache->vc_hit_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Write Buffer") == 0) {
+                cache->wb_entries = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Banks") == 0) {
+                cache->banks = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Bank Select Bit") == 0) {
+                cache->bank_bit = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Bank Busy") == 0) {
+                cache->bank_busy = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Bank Queue") == 0) {
+                cache->bank_queue = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Fast Hit Time") == 0) {
+                cache->fast_hit_time = json_uint(buffer, v);
+            } else if (jsoneq(buffer, &t[i], "Mispredict Penalty") == 0) {
+                cache->mispredict_penalty = json_uint(buffer, v);
+            }
+        }
+    }
+}
+
+// Helpers to parse the policies of the hierarchy or of one level
+static enum replacement_policy parse_rp(const char *buffer, jsmntok_t *tok)
+{
+    if (strncmp("LRU", buffer + tok->start, 3) == 0) {
+        return LRU;
+    } else if (strncmp("LFU", buffer + tok->start, 3) == 0) {
+        return LFU;
+    } else if (strncmp("FIFO", buffer + tok->start, 4) == 0) {
+        return FIFO;
+    }
+    return LRU; // Default is LRU
+}
+static enum write_policy parse_wp(const char *buffer, jsmntok_t *tok)
+{
+    if (strncmp("WBWA", buffer + tok->start, 4) == 0) {
+        return WBWA;
+    } else if (strncmp("WTWNA", buffer + tok->start, 5) == 0) {
+        return WTWNA;
+    } else if (strncmp("WBWNA", buffer + tok->start, 5) == 0) {
+        return WBWNA;
+    } else if (strncmp("WTWA", buffer + tok->start, 4) == 0) {
+        return WTWA;
+    }
+    return WBWA; // Default is write back write allocate
+}
+static enum inclusion_policy parse_inclusion(const char *buffer, jsmntok_t *tok)
+{
+    if (strncmp("Inclusive", buffer + tok->start, 9) == 0) {
+        return INCLUSIVE;
+    } else if (strncmp("Exclusive", buffer + tok->start, 9) == 0) {
+        return EXCLUSIVE;
+    }
+    return NINE; // Default is non-inclusive non-exclusive
+}
+
+// Helper to parse one level of a "Levels" array -- does not check for error
+// A unified level keeps its cache parameters in the level object itself, a split
+// level has an "Instruction" and a "Data" object
+static void parse_level(const char *buffer, jsmntok_t *t, int index, int r, struct level_config_t *level)
+{
+    parse_cache(buffer, t, index, r, &level->data);
+    int end = json_next(t, index, r);
+    for (int i = index + 1; i < end; i = json_next(t, i + 1, r)) {
+        jsmntok_t *v = &t[i + 1];
+        if (jsoneq(buffer, &t[i], "Name") == 0 && v->type == JSMN_STRING) {
+            int len = v->end - v->start;
+            if (len > (int)sizeof(level->name) - 1) {
+                len = sizeof(level->name) - 1;
+            }
+            memcpy(level->name, buffer + v->start, len);
+            level->name[len] = '\0';
+        } else if (jsoneq(buffer, &t[i], "Instruction") == 0 && v->type == JSMN_OBJECT) {
+            level->split = true;
+            parse_cache(buffer, t, i + 1, r, &level->inst);
+        } else if (jsoneq(buffer, &t[i], "Data") == 0 && v->type == JSMN_OBJECT) {
+            level->split = true;
+            parse_cache(buffer, t, i + 1, r, &level->data);
+        } else if (jsoneq(buffer, &t[i], "Replacement Policy") == 0 && v->type == JSMN_STRING) {
+            level->rp = parse_rp(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Write Policy") == 0 && v->type == JSMN_STRING) {
+            level->wp = parse_wp(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Inclusion") == 0 && v->type == JSMN_STRING) {
+            level->inclusion = parse_inclusion(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Hit Time") == 0 && v->type == JSMN_PRIMITIVE) {
+            level->hit_time = strtod(buffer + v->start, NULL);
+        } else if (jsoneq(buffer, &t[i], "Private") == 0 && v->type == JSMN_PRIMITIVE) {
+            level->sharing = buffer[v->start] == 't' ? PRIVATE : SHARED;
+        } else if (jsoneq(buffer, &t[i], "Min C") == 0 && v->type == JSMN_PRIMITIVE) {
+            level->min_c = json_uint(buffer, v);
+        } else if (jsoneq(buffer, &t[i], "Access Time") == 0 && v->type == JSMN_ARRAY) {
+            // One row per associativity (DM, 2W, 4W, 8W, FA), one column per C from "Min C" up
+            uint64_t rows = 0;
+            uint64_t cols = 0;
+            int rows_end = json_next(t, i + 1, r);
+            for (int j = i + 2; j < rows_end; j = json_next(t, j, r), rows++) {
+                if (t[j].type != JSMN_ARRAY || rows == 5) {
+                    print_err_usage("Access Time must have one array of hit times per associativity");
+                }
+                cols = 0;
+                int cols_end = json_next(t, j, r);
+                for (int k = j + 1; k < cols_end; k = json_next(t, k, r), cols++) {
+                    if (cols < MAX_TABLE_C) {
+                        level->access_time[rows][cols] = strtod(buffer + t[k].start, NULL);
+                    }
+                }
+                if (cols == 0 || cols > MAX_TABLE_C) {
+                    print_err_usage("Access Time rows must have between 1 and 8 hit times");
+                }
+            }
+            if (rows != 5) {
+                print_err_usage("Access Time must have one array of hit times per associativity");
+            }
+            level->max_c = cols;
+        }
     }
 }
 
@@ -137,14 +950,14 @@ static void parse_cache(const char *buffer, jsmntok_t *t, int index, struct cach
 static void parse_config(FILE *fin, struct sim_config_t *sim_conf)
 {
     jsmn_parser p;
-    jsmntok_t t[128]; // Not expecting a really large input so this should work
+    jsmntok_t t[1024]; // Not expecting a really large input so this should work
     jsmn_init(&p);
 
-    char buffer[1024]; // For reading configuration file contents
+    char buffer[16384]; // For reading configuration file contents
 
     // Read config file contents
     if (fin) {
-        size_t len = fread(buffer, sizeof(char), 1024, fin);
+        size_t len = fread(buffer, sizeof(char), sizeof(buffer) - 1, fin);
         if (ferror(fin) != 0) {
             print_err_usage("Error reading input configuration file");
         }
@@ -164,46 +977,148 @@ static void parse_config(FILE *fin, struct sim_config_t *sim_conf)
             if (t[i + 1].type != JSMN_OBJECT) {
                 print_err_usage("L1 Instruction Cache configuration error");
             }
-            parse_cache(buffer, t, i + 2, &(sim_conf->l1inst));
-            i += 8;
+            parse_cache(buffer, t, i + 1, r, &(sim_conf->levels[0].inst));
+            sim_conf->levels[0].split = true;
+            sim_conf->num_levels = sim_conf->num_levels < 1 ? 1 : sim_conf->num_levels;
+            i = json_next(t, i + 1, r);
         } else if (jsoneq(buffer, &t[i], "L1 Data") == 0) {
             if (t[i + 1].type != JSMN_OBJECT) {
                 print_err_usage("L1 Data Cache configuration error");
             }
-            parse_cache(buffer, t, i + 2, &(sim_conf->l1data));
-            i += 8;
+            parse_cache(buffer, t, i + 1, r, &(sim_conf->levels[0].data));
+            sim_conf->levels[0].split = true;
+            sim_conf->num_levels = sim_conf->num_levels < 1 ? 1 : sim_conf->num_levels;
+            i = json_next(t, i + 1, r);
         } else if (jsoneq(buffer, &t[i], "L2 Unified") == 0) {
             if (t[i + 1].type != JSMN_OBJECT) {
                 print_err_usage("L2 Unified Cache configuration error");
             }
-            parse_cache(buffer, t, i + 2, &(sim_conf->l2unified));
-            i += 8;
+            parse_cache(buffer, t, i + 1, r, &(sim_conf->levels[1].data));
+            sim_conf->num_levels = sim_conf->num_levels < 2 ? 2 : sim_conf->num_levels;
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Levels") == 0) {
+            if (t[i + 1].type != JSMN_ARRAY) {
+                print_err_usage("Levels configuration error");
+            }
+            // The levels replace the L1 and L2 keys, from the level closest to the core down
+            sim_conf->num_levels = 0;
+            int end = json_next(t, i + 1, r);
+            for (int j = i + 2; j < end; j = json_next(t, j, r)) {
+                if (t[j].type != JSMN_OBJECT || sim_conf->num_levels == MAX_LEVELS) {
+                    print_err_usage("Levels configuration error");
+                }
+                struct level_config_t *level = &sim_conf->levels[sim_conf->num_levels++];
+                level->split = false;
+                parse_level(buffer, t, j, r, level);
+            }
+            i = end;
         } else if (jsoneq(buffer, &t[i], "Replacement Policy") == 0) {
             if (t[i + 1].type != JSMN_STRING) {
                 print_err_usage("Replacement Policy configuration error");
             } else {
-                if (strncmp("LRU", buffer + t[i + 1].start, 3) == 0) {
-                    sim_conf->rp = LRU;
-                } else if (strncmp("LFU", buffer + t[i + 1].start, 3) == 0) {
-                    sim_conf->rp = LFU;
-                } else if (strncmp("FIFO", buffer + t[i + 1].start, 4) == 0) {
-                    sim_conf->rp = FIFO;
-                } else {
-                    sim_conf->rp = LRU; // Default is LRU
-                }
+                sim_conf->rp = parse_rp(buffer, &t[i + 1]);
             }
             i += 2;
         } else if (jsoneq(buffer, &t[i], "Write Policy") == 0) {
             if (t[i + 1].type != JSMN_STRING) {
                 print_err_usage("Write Policy configuration error");
             } else {
-                if (strncmp("WBWA", buffer + t[i + 1].start, 4) == 0) {
-                    sim_conf->wp = WBWA;
-                } else if (strncmp("WTWNA", buffer + t[i + 1].start, 5) == 0) {
-                    sim_conf->wp = WTWNA;
-                } else {
-                    sim_conf->wp = WBWA; // Default is write back write allocate
-                }
+                sim_conf->wp = parse_wp(buffer, &t[i + 1]);
+            }
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Inclusion") == 0) {
+            if (t[i + 1].type != JSMN_STRING) {
+                print_err_usage("Inclusion configuration error");
+            } else {
+                sim_conf->inclusion = parse_inclusion(buffer, &t[i + 1]);
+            }
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Main Memory") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Main Memory configuration error");
+            }
+            parse_memory(buffer, t, i + 1, r, &(sim_conf->mem));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Virtual Memory") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Virtual Memory configuration error");
+            }
+            parse_vm(buffer, t, i + 1, r, &(sim_conf->vm));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Analysis") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Analysis configuration error");
+            }
+            parse_analysis(buffer, t, i + 1, r, &(sim_conf->analysis));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Time Series") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Time Series configuration error");
+            }
+            parse_timeseries(buffer, t, i + 1, r, &(sim_conf->timeseries));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Region") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Region configuration error");
+            }
+            parse_region(buffer, t, i + 1, r, &(sim_conf->region));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Generator") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Generator configuration error");
+            }
+            parse_generator(buffer, t, i + 1, r, &(sim_conf->generator));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Checkpoint") == 0) {
+            if (t[i + 1].type != JSMN_OBJECT) {
+                print_err_usage("Checkpoint configuration error");
+            }
+            parse_checkpoint(buffer, t, i + 1, r, &(sim_conf->checkpoint));
+            i = json_next(t, i + 1, r);
+        } else if (jsoneq(buffer, &t[i], "Event Log") == 0) {
+            int len = t[i + 1].end - t[i + 1].start;
+            if (t[i + 1].type != JSMN_STRING) {
+                print_err_usage("Event Log configuration error");
+            } else if (len >= (int)sizeof(sim_conf->event_log)) {
+                print_err_usage("Event Log file name too long");
+            }
+            memcpy(sim_conf->event_log, buffer + t[i + 1].start, len);
+            sim_conf->event_log[len] = '\0';
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Latency Histogram") == 0) {
+            if (t[i + 1].type != JSMN_PRIMITIVE) {
+                print_err_usage("Latency Histogram configuration error");
+            }
+            sim_conf->latency_histogram = buffer[t[i + 1].start] == 't';
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Miss Classification") == 0) {
+            if (t[i + 1].type != JSMN_PRIMITIVE) {
+                print_err_usage("Miss Classification configuration error");
+            }
+            sim_conf->classify_misses = buffer[t[i + 1].start] == 't';
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Issue Interval") == 0) {
+            if (t[i + 1].type != JSMN_PRIMITIVE) {
+                print_err_usage("Issue Interval configuration error");
+            }
+            sim_conf->issue_interval = json_uint(buffer, &t[i + 1]);
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Cores") == 0) {
+            if (t[i + 1].type != JSMN_PRIMITIVE) {
+                print_err_usage("Cores configuration error");
+            }
+            sim_conf->cores = json_uint(buffer, &t[i + 1]);
+            i += 2;
+        } else if (jsoneq(buffer, &t[i], "Scheduler") == 0) {
+            if (t[i + 1].type != JSMN_STRING) {
+                print_err_usage("Scheduler configuration error");
+            }
+            if (jsoneq(buffer, &t[i + 1], "Round Robin") == 0) {
+                sim_conf->scheduler = ROUND_ROBIN;
+            } else if (jsoneq(buffer, &t[i + 1], "Latency") == 0) {
+                sim_conf->scheduler = LATENCY_ORDER;
+            } else {
+                print_err_usage("Scheduler must be Round Robin or Latency");
             }
             i += 2;
         } else {
@@ -212,72 +1127,518 @@ static void parse_config(FILE *fin, struct sim_config_t *sim_conf)
     }
 }
 
+// Helper to fill in the defaults for everything the configuration file may leave out
+static void default_config(struct sim_config_t *sim_conf)
+{
+    memset(sim_conf, 0, sizeof(*sim_conf));
+    sim_conf->rp = LRU;
+    sim_conf->wp = WBWA;
+    sim_conf->inclusion = NINE;
+    sim_conf->issue_interval = 1;
+    sim_conf->analysis.format = OUTPUT_CSV;
+    sim_conf->analysis.top_misses = 16;
+    sim_conf->timeseries.format = OUTPUT_CSV;
+    sim_conf->timeseries.interval = 100000;
+    sim_conf->cores = 1;
+    sim_conf->scheduler = ROUND_ROBIN;
+    sim_conf->region.segments = 1;
+    sim_conf->generator.accesses = 1000000;
+    sim_conf->generator.seed = 1;
+    sim_conf->generator.working_set = 1 << 20;
+    sim_conf->generator.stride = 64;
+    sim_conf->generator.zipf_exponent = 0.99;
+    sim_conf->generator.mix[1] = 70;
+    sim_conf->generator.mix[2] = 30;
+    sim_conf->generator.code_size = 16 << 10;
+
+    for (uint64_t k = 0; k < MAX_LEVELS; k++) {
+        struct cache_config_t *caches[] = {&sim_conf->levels[k].inst, &sim_conf->levels[k].data};
+        for (int i = 0; i < 2; i++) {
+            caches[i]->sectors = 1;
+            caches[i]->indexing = BIT_SLICE;
+            caches[i]->insertion = INSERT_MRU;
+            caches[i]->pf = NO_PREFETCH;
+            caches[i]->pf_degree = 1;
+            caches[i]->pf_distance = 1;
+            caches[i]->vc_hit_time = 1;
+            caches[i]->mispredict_penalty = 1;
+            caches[i]->banks = 1;
+            caches[i]->bank_busy = 2;
+            caches[i]->bank_queue = 8;
+        }
+    }
+
+    // TLB sizes of a recent desktop core, used once "Virtual Memory" is given
+    // The first level TLBs are looked up in parallel with the L1 and add nothing to a hit
+    sim_conf->vm.itlb = {64, 2, 0};
+    sim_conf->vm.dtlb = {64, 2, 0};
+    sim_conf->vm.stlb = {1024, 3, 7};
+
+    // DDR-like timing in CPU cycles, used once "Model" is set to "DRAM"
+    sim_conf->mem.model = MEM_FIXED;
+    sim_conf->mem.mapping = RO_BA_CH_CO;
+    sim_conf->mem.channels = 2;
+    sim_conf->mem.banks = 8;
+    sim_conf->mem.row_size = 8192;
+    sim_conf->mem.row_hit_time = 40;
+    sim_conf->mem.row_miss_time = 80;
+    sim_conf->mem.row_conflict_time = 120;
+    sim_conf->mem.bus_time = 8;
+    sim_conf->mem.queue_depth = 16;
+}
+
+// Helper to give every level a name, its policies and an access time table once the file is read
+// L1 and L2 fall back on the tables of the project, deeper levels need their own or a "Hit Time"
+static void finish_config(struct sim_config_t *sim_conf)
+{
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        struct level_config_t *level = &sim_conf->levels[k];
+        if (level->name[0] == '\0') {
+            snprintf(level->name, sizeof(level->name), "L%" PRIu64, k + 1);
+        }
+        if (!level->rp) {
+            level->rp = sim_conf->rp;
+        }
+        if (!level->wp) {
+            level->wp = sim_conf->wp;
+        }
+        if (k == 0) {
+            level->inclusion = NINE;
+        } else if (!level->inclusion) {
+            level->inclusion = sim_conf->inclusion;
+        }
+        if (!level->sharing) {
+            level->sharing = k == 0 ? PRIVATE : SHARED;
+        }
+        if (level->max_c) {
+            level->max_c += level->min_c - 1;
+        } else if (level->hit_time == 0 && k < 2) {
+            level->min_c = k == 0 ? MIN_L1_C : MIN_L2_C;
+            level->max_c = k == 0 ? MAX_L1_C : MAX_L2_C;
+            for (int row = 0; row < 5; row++) {
+                for (uint64_t col = 0; col <= level->max_c - level->min_c; col++) {
+                    level->access_time[row][col] = k == 0 ? L1_ACCESS_TIME[row][col] : L2_ACCESS_TIME[row][col];
+                }
+            }
+        }
+    }
+}
+
+static bool is_pow2(uint64_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
 // Helper to verify that the input cache configuration is valid
 static void verify_config(const struct sim_config_t *sim_conf)
 {
-    // Make sure block sizes are the same
-    if (!((sim_conf->l1data.b == sim_conf->l1inst.b) &&  (sim_conf->l1data.b == sim_conf->l2unified.b))) {
-        print_error_exit("Block sizes across caches must be the same\n");
+    if (sim_conf->num_levels == 0) {
+        print_error_exit("The hierarchy needs at least one level\n");
     }
 
-    // Ensure L1 size is within bounds
-    if (sim_conf->l1data.c < MIN_L1_C || sim_conf->l1data.c > MAX_L1_C || sim_conf->l1inst.c < MIN_L1_C || sim_conf->l1inst.c > MAX_L1_C) {
-        print_error_exit("L1 Data and Instruction caches cannot be smaller than 512B nor larger than 32KiB\n");
+    // Every segment is a process of its own, the outputs of a run can only be written by one
+    if (sim_conf->region.segments == 0 || sim_conf->region.segments > MAX_SEGMENTS) {
+        print_error_exit("Segments must be between 1 and %d\n", MAX_SEGMENTS);
+    }
+    if (sim_conf->region.segments > 1 && (sim_conf->event_log[0] || sim_conf->timeseries.file[0] || sim_conf->analysis.file[0])) {
+        print_error_exit("Segments can not write an Event Log, Time Series or Analysis\n");
+    }
+    if (has_region(sim_conf) && (sim_conf->checkpoint.save[0] || sim_conf->checkpoint.restore[0])) {
+        print_error_exit("A Region can not be combined with a Checkpoint\n");
     }
 
-    // Ensure L2 size is within bounds
-    if (sim_conf->l2unified.c < MIN_L2_C || sim_conf->l2unified.c > MAX_L2_C) {
-        print_error_exit("L2 cache cannot be smaller than 128KiB nor larger than 2MiB");
+    // A generator replaces the traces, so it has no region to pick or position to save
+    const struct generator_config_t *gen = &sim_conf->generator;
+    if (gen->pattern && (has_region(sim_conf) || sim_conf->checkpoint.save[0] || sim_conf->checkpoint.restore[0])) {
+        print_error_exit("A Generator can not be combined with a Region or a Checkpoint\n");
+    }
+    if (gen->pattern && (gen->working_set < 64 || gen->stride == 0 || gen->code_size < 4 || gen->zipf_exponent < 0)) {
+        print_error_exit("Generator needs a Working Set of at least 64, a Code Size of at least 4, a Stride and a Zipf Exponent of at least 0\n");
+    }
+    if (gen->pattern && gen->mix[0] + gen->mix[1] + gen->mix[2] == 0) {
+        print_error_exit("Generator Mix needs at least one weight\n");
     }
 
-    // Ensure L2 is bigger than L1 caches combined
-    if ((1ul << sim_conf->l2unified.c) < ((1ul << sim_conf->l1data.c) + (1ul << sim_conf->l1inst.c))) {
-        print_error_exit("The unified L2 cannot be smaller than the L1 caches\n");
+    // Translations are not part of a checkpoint
+    if ((sim_conf->checkpoint.save[0] || sim_conf->checkpoint.restore[0]) && sim_conf->vm.page) {
+        print_error_exit("Checkpoints do not cover Virtual Memory\n");
+    }
+
+    // Windows of the time series must be at least one access or cycle long
+    if (sim_conf->timeseries.file[0] && sim_conf->timeseries.interval == 0) {
+        print_error_exit("Time Series windows must be at least 1 long\n");
+    }
+
+    // Ensure every core gets its private levels on top of at least one shared level
+    if (sim_conf->cores == 0 || sim_conf->cores > MAX_CORES) {
+        print_error_exit("Cores must be between 1 and %d\n", MAX_CORES);
+    }
+    uint64_t num_caches = 0;
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        if (k > 0 && level->sharing == PRIVATE && sim_conf->levels[k - 1].sharing == SHARED) {
+            print_error_exit("%s cannot be private below a shared level\n", level->name);
+        }
+        num_caches += (level->split ? 2 : 1) * (level->sharing == PRIVATE ? sim_conf->cores : 1);
+    }
+    if (sim_conf->cores > 1 && sim_conf->levels[sim_conf->num_levels - 1].sharing == PRIVATE) {
+        print_error_exit("Multiple cores need a shared level\n");
+    }
+    if (num_caches > MAX_CACHES) {
+        print_error_exit("The hierarchy cannot have more than %d caches\n", MAX_CACHES);
+    }
+
+    uint64_t above = 0; // capacity of the level above
+    uint64_t above_b = 0; // biggest block size of the level above
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        uint64_t capacity = 0;
+        uint64_t b = 0;
+        for (int side = level->split ? 0 : 1; side < 2; side++) {
+            const struct cache_config_t *cache = side == 0 ? &level->inst : &level->data;
+            capacity += 1ul << cache->c;
+            b = cache->b > b ? cache->b : b;
+
+            // Make sure a block of the level above fits in one sector, and sectors split blocks evenly
+            if (!is_pow2(cache->sectors) || cache->sectors > 64 || cache->sectors > (1ul << cache->b)) {
+                print_error_exit("%s sectors must be a power of two up to 64 and no more than the block size\n", level->name);
+            }
+            if (cache->b - __builtin_ctzll(cache->sectors) < above_b) {
+                print_error_exit("%s blocks and sectors cannot be smaller than the blocks of the level above\n", level->name);
+            }
+
+            // Ensure the cache size is within the level's access time table
+            if (level->hit_time == 0 && level->max_c == 0) {
+                print_error_exit("%s needs a Hit Time or an Access Time table\n", level->name);
+            }
+            if (level->hit_time == 0 && (cache->c < level->min_c || cache->c > level->max_c)) {
+                print_error_exit("%s caches must have a C between %" PRIu64 " and %" PRIu64 "\n", level->name, level->min_c, level->max_c);
+            }
+            if (cache->c < cache->b + cache->s) {
+                print_error_exit("%s caches must hold at least one set\n", level->name);
+            }
+
+            // Hashed indexing needs more than one set
+            if (cache->indexing != BIT_SLICE && cache->c == cache->b + cache->s) {
+                print_error_exit("%s is fully associative and has no index to hash\n", level->name);
+            }
+
+            // Way masks must leave every class of every core a way to fill
+            for (int j = 0; j < 3; j++) {
+                for (uint64_t core = 0; core < sim_conf->cores; core++) {
+                    uint64_t ways = (cache->class_ways[j] ? cache->class_ways[j] : ~0ull) & (cache->core_ways[core] ? cache->core_ways[core] : ~0ull);
+                    if ((cache->class_ways[j] || cache->core_ways[core]) && (cache->s > 6 || (ways & ((1ull << (1ull << cache->s)) - 1)) == 0)) {
+                        print_error_exit("%s way masks need at most 64 ways and a way for every class and core\n", level->name);
+                    }
+                }
+            }
+
+            // Banks are selected by address bits, at most MAX_BANKS of them
+            if (cache->banks == 0 || cache->banks > MAX_BANKS || (cache->banks & (cache->banks - 1))) {
+                print_error_exit("%s must have a power of 2 number of banks up to %" PRIu64 "\n", level->name, MAX_BANKS);
+            }
+            if (cache->banks > 1 && (cache->bank_busy == 0 || cache->bank_queue == 0 || cache->bank_bit + __builtin_ctzll(cache->banks) > 64)) {
+                print_error_exit("%s banks need a Bank Busy and Bank Queue of at least 1 and select bits within the address\n", level->name);
+            }
+
+            // Way prediction hides the associativity of a first level cache
+            if (cache->way_pred != NO_WAY_PREDICTION && k != 0) {
+                print_error_exit("%s cannot have a way predictor, only first level caches can\n", level->name);
+            }
+
+            // Only a level that other levels do not rely on holding a block can bypass it
+            if (cache->bypass && (k == 0 || level->inclusion != NINE)) {
+                print_error_exit("%s cannot bypass, only non-inclusive levels below the first can\n", level->name);
+            }
+
+            // Write buffers only sit below the first level data cache
+            if (cache->wb_entries && (k > 0 || side == 0)) {
+                print_error_exit("Only the first level data cache can have a Write Buffer\n");
+            }
+            // A WBWA cache keeps every store, it never sends one to a write buffer
+            if (cache->wb_entries && level->wp == WBWA) {
+                print_error_exit("%s cannot have a Write Buffer with WBWA, only with a policy that writes through or around\n", level->name);
+            }
+
+            // Ensure prefetchers request at least one block ahead of the trigger
+            if (cache->pf != NO_PREFETCH && (cache->pf_degree == 0 || cache->pf_degree > MAX_PREFETCH_DEGREE ||
+                                             cache->pf_distance == 0 || cache->pf_distance > MAX_PREFETCH_DISTANCE)) {
+                print_error_exit("Prefetch degree must be between 1 and %" PRIu64 " and prefetch distance between 1 and %" PRIu64 "\n",
+                                 MAX_PREFETCH_DEGREE, MAX_PREFETCH_DISTANCE);
+            }
+        }
+
+        // Ensure every level is bigger than the level above it, and that a unified level only has unified levels below
+        if (capacity < above) {
+            print_error_exit("%s cannot be smaller than the level above it\n", level->name);
+        }
+        if (k > 0 && level->split && !sim_conf->levels[k - 1].split) {
+            print_error_exit("%s cannot be split below a unified level\n", level->name);
+        }
+        above = capacity;
+        above_b = b;
+    }
+
+    // Ensure the TLBs can be indexed by page number, only the L2 TLB is optional
+    if (sim_conf->vm.page) {
+        const struct tlb_config_t *tlbs[] = {&sim_conf->vm.itlb, &sim_conf->vm.dtlb, &sim_conf->vm.stlb};
+        for (int i = 0; i < 3; i++) {
+            if (i < 2 && tlbs[i]->entries == 0) {
+                print_error_exit("ITLB and DTLB need at least one entry\n");
+            }
+            if (tlbs[i]->entries && (!is_pow2(tlbs[i]->entries) || ((uint64_t)1 << tlbs[i]->s) > tlbs[i]->entries)) {
+                print_error_exit("TLB entries must be a power of two no smaller than the associativity\n");
+            }
+        }
+    }
+
+    // Ensure the DRAM geometry can be sliced out of an address
+    if (sim_conf->mem.model == MEM_DRAM) {
+        if (!is_pow2(sim_conf->mem.channels) || !is_pow2(sim_conf->mem.banks) || !is_pow2(sim_conf->mem.row_size)) {
+            print_error_exit("DRAM channels, banks and row size must be powers of two\n");
+        }
+        if (sim_conf->mem.queue_depth == 0) {
+            print_error_exit("DRAM queue depth must be at least 1\n");
+        }
     }
 }
 
-// This function does no error checking and uses magic numbers
+// Name every cache and setup hit times from the access time tables
+// Caches go level by level, a private level has one copy per core
 static void setup_hit_times(struct sim_stats_t *sim_stats, const struct sim_config_t *sim_conf)
 {
-    // L1 Instruction
-    if (sim_conf->l1inst.s <= MAX_S) {
-        sim_stats->l1inst_hit_time = L1_ACCESS_TIME[sim_conf->l1inst.s][(sim_conf->l1inst.c - MIN_L1_C)];
-    } else {
-        sim_stats->l1inst_hit_time = L1_ACCESS_TIME[MAX_S+1][(sim_conf->l1inst.c - MIN_L1_C)];
+    char name[32];
+    sim_stats->num_caches = 0;
+    for (uint64_t k = 0; k < sim_conf->num_levels; k++) {
+        const struct level_config_t *level = &sim_conf->levels[k];
+        bool per_core = level->sharing == PRIVATE;
+        for (uint64_t core = 0; core < (per_core ? sim_conf->cores : 1); core++) {
+            for (int side = level->split ? 0 : 1; side < 2; side++) {
+                struct cache_stats_t *stats = &sim_stats->caches[sim_stats->num_caches++];
+                cache_name(name, sizeof(name), level, side);
+                if (per_core && sim_conf->cores > 1) {
+                    snprintf(stats->name, sizeof(stats->name), "Core %" PRIu64 " %s", core, name);
+                } else {
+                    snprintf(stats->name, sizeof(stats->name), "%s", name);
+                }
+                stats->level = k;
+                stats->core = per_core ? (int64_t)core : -1;
+                stats->insts = side == 0 || !level->split;
+                stats->data = side == 1;
+                stats->hit_time = level_hit_time(level, side == 0 ? &level->inst : &level->data);
+            }
+        }
     }
+}
 
-    // L1 Data
-    if (sim_conf->l1data.s <= MAX_S) {
-        sim_stats->l1data_hit_time = L1_ACCESS_TIME[sim_conf->l1data.s][(sim_conf->l1data.c - MIN_L1_C)];
-    } else {
-        sim_stats->l1data_hit_time = L1_ACCESS_TIME[MAX_S+1][(sim_conf->l1data.c - MIN_L1_C)];
+// Read the next access of a trace, "<type> <address>" or "<core> <type> <address>",
+// either followed by an optional size in bytes (0 if not given)
+// Returns false at the end of the trace
+static bool read_access(FILE *trace, uint64_t *core, char *type, uint64_t *addr, uint64_t *size)
+{
+    char line[128];
+    while (fgets(line, sizeof(line), trace) != NULL) {
+        *size = 0;
+        if (line[0] >= '0' && line[0] <= '9') {
+            if (sscanf(line, "%" SCNu64 " %c %" SCNx64 " %" SCNu64, core, type, addr, size) >= 3) {
+                return true;
+            }
+        } else if (sscanf(line, "%c %" SCNx64 " %" SCNu64, type, addr, size) >= 2) {
+            return true;
+        }
     }
+    return false;
+}
 
-    // L2 Unified
-    if (sim_conf->l2unified.s <= MAX_S) {
-        sim_stats->l2unified_hit_time = L2_ACCESS_TIME[sim_conf->l2unified.s][(sim_conf->l2unified.c - MIN_L2_C)];
-    } else {
-        sim_stats->l2unified_hit_time = L2_ACCESS_TIME[MAX_S+1][(sim_conf->l2unified.c - MIN_L2_C)];
+// Simulate up to limit accesses of a single trace
+// Returns the accesses simulated, fewer if the trace ran out
+static uint64_t simulate_trace(FILE *trace, uint64_t limit, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
+{
+    char type;
+    uint64_t addr;
+    uint64_t size;
+    uint64_t core = 0;
+    uint64_t n = 0;
+    while (n < limit && read_access(trace, &core, &type, &addr, &size)) {
+        if (core >= sim_conf->cores) {
+            print_error_exit("Trace access for core %" PRIu64 " but only %" PRIu64 " cores\n", core, sim_conf->cores);
+        }
+        core_access(core, addr, type, size, sim_stats, sim_conf);
+        core = 0;
+        n++;
     }
+    return n;
+}
+
+// Read past accesses of a trace without simulating them
+static void skip_accesses(FILE *trace, uint64_t n)
+{
+    char type;
+    uint64_t addr;
+    uint64_t size;
+    uint64_t core;
+    for (uint64_t i = 0; i < n && read_access(trace, &core, &type, &addr, &size); i++);
+}
+
+// Load the index of a trace, indexing the trace first if it has none or changed since
+static struct trace_index* open_index(const char *name, FILE *trace)
+{
+    struct trace_index *idx = trace_index_load(name);
+    if (idx != NULL) {
+        return idx;
+    }
+    idx = trace_index_create(name);
+    char type;
+    uint64_t addr;
+    uint64_t size;
+    uint64_t core;
+    rewind(trace);
+    long offset = ftell(trace);
+    while (read_access(trace, &core, &type, &addr, &size)) {
+        trace_index_add(idx, (uint64_t)offset);
+        offset = ftell(trace);
+    }
+    trace_index_save(idx);
+    return idx;
+}
+
+// Simulate the accesses from start to end of a trace after warming the caches up on
+// the accesses before start, which are left out of the statistics
+static void simulate_segment(FILE *trace, const struct trace_index *idx, uint64_t start, uint64_t end,
+                             struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
+{
+    uint64_t warm = start > sim_conf->region.warm_up ? start - sim_conf->region.warm_up : 0;
+    skip_accesses(trace, trace_index_seek(idx, trace, warm));
+    struct sim_stats_t *before = (struct sim_stats_t*) malloc(sizeof(struct sim_stats_t));
+    memcpy(before, sim_stats, sizeof(struct sim_stats_t));
+    simulate_trace(trace, start - warm, sim_stats, sim_conf);
+    memcpy(sim_stats, before, sizeof(struct sim_stats_t));
+    free(before);
+    if (start > warm) {
+        sim_warm_up_end(sim_conf);
+    }
+    simulate_trace(trace, end - start, sim_stats, sim_conf);
+}
+
+// Helpers to move the statistics of a segment through a pipe
+static bool write_all(int fd, const void *data, size_t len)
+{
+    const char *p = (const char*) data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *data, size_t len)
+{
+    char *p = (char*) data;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Simulate the region of a single trace. Segments run in processes of their own, each
+// with its own warm-up, and their statistics are merged for sim_cleanup to finish
+static void simulate_region(const char *name, FILE *trace, struct sim_stats_t *sim_stats, struct sim_config_t *sim_conf)
+{
+    const struct region_config_t *region = &sim_conf->region;
+    struct trace_index *idx = open_index(name, trace);
+    uint64_t total = trace_index_accesses(idx);
+    uint64_t start = region->skip < total ? region->skip : total;
+    uint64_t end = region->accesses && region->accesses < total - start ? start + region->accesses : total;
+    if (region->segments == 1) {
+        simulate_segment(trace, idx, start, end, sim_stats, sim_conf);
+        trace_index_destroy(idx);
+        return;
+    }
+
+    int pipes[MAX_SEGMENTS];
+    pid_t pids[MAX_SEGMENTS];
+    fflush(stdout);
+    for (uint64_t k = 0; k < region->segments; k++) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            print_error_exit("Could not create a pipe for segment %" PRIu64 "\n", k);
+        }
+        pids[k] = fork();
+        if (pids[k] < 0) {
+            print_error_exit("Could not start segment %" PRIu64 "\n", k);
+        }
+        if (pids[k] == 0) {
+            // The segment reads the trace through a file of its own
+            close(fd[0]);
+            FILE *own = fopen(name, "r");
+            if (own == NULL) {
+                _exit(EXIT_FAILURE);
+            }
+            simulate_segment(own, idx, start + (end - start) * k / region->segments,
+                             start + (end - start) * (k + 1) / region->segments, sim_stats, sim_conf);
+            sim_cleanup(sim_stats, sim_conf);
+            _exit(write_all(fd[1], sim_stats, sizeof(struct sim_stats_t)) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        close(fd[1]);
+        pipes[k] = fd[0];
+    }
+
+    struct sim_stats_t *part = (struct sim_stats_t*) malloc(sizeof(struct sim_stats_t));
+    for (uint64_t k = 0; k < region->segments; k++) {
+        int status;
+        bool received = read_all(pipes[k], part, sizeof(struct sim_stats_t));
+        close(pipes[k]);
+        waitpid(pids[k], &status, 0);
+        if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            print_error_exit("Segment %" PRIu64 " failed\n", k);
+        }
+        sim_stats_merge(sim_stats, part, region->segments, k + 1 == region->segments);
+    }
+    free(part);
+    trace_index_destroy(idx);
+}
+
+// Save the hierarchy along with where every trace continues from and the scheduler clock of its core
+static void save_checkpoint(const struct sim_config_t *sim_conf, FILE **traces, uint64_t num_traces, const struct scheduler *s)
+{
+    uint64_t offsets[2 * MAX_CORES];
+    for (uint64_t i = 0; i < num_traces; i++) {
+        offsets[i] = (uint64_t)ftell(traces[i]);
+        offsets[num_traces + i] = s != NULL ? scheduler_time(s, i) : 0;
+    }
+    checkpoint_save(sim_conf->checkpoint.save, offsets, 2 * num_traces);
 }
 
 // Drive the cache simulator
 int main(int argc, char *const argv[])
 {
-    if (argc < 5) {
+    if (argc < 3) {
         print_err_usage("Input configuration file not provided");
     }
 
     FILE *fin = stdin; // config file
-    FILE *trace = NULL; // trace file
+    FILE *traces[MAX_CORES]; // trace files, one per core or a single one for all
+    const char *trace_names[MAX_CORES];
+    const char *ring_name = NULL; // shared memory ring instead of trace files
+    uint64_t num_traces = 0;
 
     struct sim_config_t sim_conf;
+    default_config(&sim_conf);
 
     struct sim_stats_t sim_stats;
     memset(&sim_stats, 0, sizeof(sim_stats));
 
     int opt;
-    while (-1 != (opt = getopt(argc, argv, "c:C:i:I:h"))) {
+    while (-1 != (opt = getopt(argc, argv, "c:C:i:I:s:S:h"))) {
         switch (opt) {
             case 'c':
             case 'C':
@@ -286,18 +1647,28 @@ int main(int argc, char *const argv[])
                     print_err_usage("Could not open input configuration file");
                 }
                 parse_config(fin, &sim_conf); // read the json config file
+                finish_config(&sim_conf); // fill in what the levels left to the hierarchy defaults
                 verify_config(&sim_conf); // verify that the configuration is legal
                 setup_hit_times(&sim_stats, &sim_conf); // setup hit times from the hit times table
                 break;
 
             case 'i':
             case 'I':
-                trace = fopen(optarg, "r");
-                if (trace == NULL) {
+                if (num_traces == MAX_CORES) {
+                    print_err_usage("Too many trace files");
+                }
+                trace_names[num_traces] = optarg;
+                traces[num_traces] = fopen(optarg, "r");
+                if (traces[num_traces++] == NULL) {
                     print_err_usage("Could not open the input trace file");
                 }
                 break;
 
+            case 's':
+            case 'S':
+                ring_name = optarg;
+                break;
+
             case 'h':
                 print_err_usage("");
                 break;
@@ -316,18 +1687,113 @@ int main(int argc, char *const argv[])
     // Run the simulator -- one access at a time
     char type;
     uint64_t addr;
-    while (!feof(trace)) {
-        int ret = fscanf(trace, "%c %" PRIx64 "\n", &type, &addr);
-        if (ret == 2) {
-            cache_access(addr, type, &sim_stats, &sim_conf);
+    uint64_t size;
+    uint64_t core;
+    uint64_t accesses = 0;
+    bool save = sim_conf.checkpoint.save[0] && sim_conf.checkpoint.at;
+    if (num_traces == 0 && ring_name == NULL && !sim_conf.generator.pattern) {
+        print_err_usage("Input trace file not provided");
+    }
+    if (sim_conf.generator.pattern && (num_traces || ring_name != NULL)) {
+        print_error_exit("A Generator can not be combined with trace files or a ring\n");
+    }
+    if (ring_name != NULL && (num_traces || has_region(&sim_conf) || sim_conf.checkpoint.save[0] || sim_conf.checkpoint.restore[0])) {
+        print_error_exit("A ring can not be combined with trace files, a Region or a Checkpoint\n");
+    }
+    uint64_t offsets[2 * MAX_CORES] = {0};
+    if (sim_conf.checkpoint.restore[0]) {
+        // Start from the saved caches and skip the accesses they have seen
+        checkpoint_restore(sim_conf.checkpoint.restore, offsets, 2 * num_traces);
+        for (uint64_t i = 0; i < num_traces; i++) {
+            if (fseek(traces[i], (long)offsets[i], SEEK_SET) != 0) {
+                print_error_exit("Could not seek the trace to the checkpoint\n");
+            }
         }
     }
+    if (sim_conf.generator.pattern) {
+        // Synthetic accesses, the cores taking turns
+        struct generator *g = generator_create(&sim_conf.generator, sim_conf.cores);
+        while (generator_next(g, &core, &type, &addr, &size)) {
+            core_access(core, addr, type, size, &sim_stats, &sim_conf);
+        }
+        generator_destroy(g);
+    } else if (ring_name != NULL) {
+        // Accesses of a live producer, each naming its core like a single trace
+        struct shm_ring *ring = shm_ring_attach(ring_name);
+        struct shm_record *batch = (struct shm_record*) malloc(RING_BATCH * sizeof(struct shm_record));
+        uint64_t n;
+        while ((n = shm_ring_read(ring, batch, RING_BATCH)) > 0) {
+            for (uint64_t i = 0; i < n; i++) {
+                if (batch[i].core >= sim_conf.cores) {
+                    // remove the ring, the producer then stops at the next full ring
+                    shm_ring_detach(ring);
+                    print_error_exit("Ring access for core %u but only %" PRIu64 " cores\n", batch[i].core, sim_conf.cores);
+                }
+                core_access(batch[i].core, batch[i].addr, (char)batch[i].type, batch[i].size, &sim_stats, &sim_conf);
+            }
+        }
+        free(batch);
+        shm_ring_detach(ring);
+    } else if (has_region(&sim_conf)) {
+        // Only part of a single trace, found through its index
+        if (num_traces != 1) {
+            print_error_exit("A Region needs a single trace\n");
+        }
+        simulate_region(trace_names[0], traces[0], &sim_stats, &sim_conf);
+    } else if (num_traces == 1) {
+        // A single trace names the core of every access, core 0 if it does not
+        core = 0;
+        while (read_access(traces[0], &core, &type, &addr, &size)) {
+            if (core >= sim_conf.cores) {
+                print_error_exit("Trace access for core %" PRIu64 " but only %" PRIu64 " cores\n", core, sim_conf.cores);
+            }
+            core_access(core, addr, type, size, &sim_stats, &sim_conf);
+            core = 0;
+            if (save && ++accesses == sim_conf.checkpoint.at) {
+                save_checkpoint(&sim_conf, traces, num_traces, NULL);
+            }
+        }
+    } else {
+        // One trace per core, interleaved by the scheduler until every trace ran out
+        if (num_traces != sim_conf.cores) {
+            print_error_exit("%" PRIu64 " trace files for %" PRIu64 " cores\n", num_traces, sim_conf.cores);
+        }
+        struct scheduler *s = scheduler_create(num_traces);
+        scheduler_restart(s, offsets + num_traces);
+        uint64_t next;
+        while (scheduler_next(s, &next)) {
+            core = next;
+            if (!read_access(traces[next], &core, &type, &addr, &size)) {
+                continue;
+            }
+            if (core != next) {
+                print_error_exit("Trace of core %" PRIu64 " has an access for core %" PRIu64 "\n", next, core);
+            }
+            uint64_t latency = core_access(next, addr, type, size, &sim_stats, &sim_conf);
+            scheduler_advance(s, next, sim_conf.scheduler == LATENCY_ORDER ? sim_conf.issue_interval + latency : 1);
+            if (save && ++accesses == sim_conf.checkpoint.at) {
+                save_checkpoint(&sim_conf, traces, num_traces, s);
+            }
+        }
+        if (sim_conf.checkpoint.save[0] && !save) {
+            save_checkpoint(&sim_conf, traces, num_traces, s);
+        }
+        scheduler_destroy(s);
+    }
 
-    fclose(trace);
+    if (sim_conf.checkpoint.save[0] && !save && num_traces == 1) {
+        save_checkpoint(&sim_conf, traces, num_traces, NULL);
+    } else if (save && accesses < sim_conf.checkpoint.at) {
+        fprintf(stderr, "The traces ended after %" PRIu64 " accesses, no checkpoint saved\n", accesses);
+    }
+
+    for (uint64_t i = 0; i < num_traces; i++) {
+        fclose(traces[i]);
+    }
 
     sim_cleanup(&sim_stats, &sim_conf);
 
-    print_sim_output(&sim_stats);
+    print_sim_output(&sim_stats, &sim_conf);
 
     return 0;
 }
@@ -0,0 +1,170 @@
+/**
+ * @file classify.cpp
+ * @brief Compulsory, capacity and conflict miss classification for the cache simulator
+ *
+ * A miss is compulsory the first time its block is brought in, which a set of
+ * block numbers remembers. Any other miss is a capacity miss if a fully
+ * associative LRU cache of the same capacity, given the same accesses, misses
+ * too, and a conflict miss if that cache hits. The shadow keeps its blocks on
+ * a recency list of array nodes found through a map of block numbers, so a
+ * lookup, a promotion and an eviction are all O(1).
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "classify.hpp"
+#include "u64_map.hpp"
+
+static const uint64_t SEEN_INITIAL_ENTRIES = 1024;
+static const uint32_t NONE = UINT32_MAX;
+
+typedef struct lru_node {
+    uint64_t blk;
+    uint32_t prev;      // towards the most recently used
+    uint32_t next;      // towards the least recently used
+} lru_node;
+
+struct classifier {
+    struct u64_map* seen;   // block numbers brought in so far
+    lru_node* nodes;    // shadow blocks
+    uint64_t capacity;
+    uint64_t used;
+    uint32_t head;      // most recently used
+    uint32_t tail;      // least recently used
+    struct u64_map* slots;  // node of a shadow block by block number
+};
+
+static void list_unlink(struct classifier *mc, uint32_t n) {
+    lru_node *node = &mc->nodes[n];
+    if (node->prev != NONE) {
+        mc->nodes[node->prev].next = node->next;
+    } else {
+        mc->head = node->next;
+    }
+    if (node->next != NONE) {
+        mc->nodes[node->next].prev = node->prev;
+    } else {
+        mc->tail = node->prev;
+    }
+}
+
+static void list_push(struct classifier *mc, uint32_t n) {
+    mc->nodes[n].prev = NONE;
+    mc->nodes[n].next = mc->head;
+    if (mc->head != NONE) {
+        mc->nodes[mc->head].prev = n;
+    } else {
+        mc->tail = n;
+    }
+    mc->head = n;
+}
+
+struct classifier* classifier_create(uint64_t blocks)
+{
+    struct classifier *mc = (struct classifier*) malloc(sizeof(struct classifier));
+    mc->seen = u64_map_create(SEEN_INITIAL_ENTRIES, 0);
+    mc->capacity = blocks;
+    mc->used = 0;
+    mc->head = NONE;
+    mc->tail = NONE;
+    mc->nodes = (lru_node*) malloc(blocks * sizeof(lru_node));
+    mc->slots = u64_map_create(2 * blocks, sizeof(uint32_t));
+    return mc;
+}
+
+/**
+ * Function to pass one demand access to the classifier. The shadow cache is
+ * updated whether the cache hit or not, and like the cache only brings in the
+ * block if the access allocates
+ * Returns the class the access would have if the cache missed
+ *
+ * @param mc The classifier of the cache
+ * @param blk Block number of the access
+ * @param allocate False for a store that does not allocate
+ */
+enum miss_class classifier_access(struct classifier *mc, uint64_t blk, bool allocate)
+{
+    bool first = false;
+    if (allocate) {
+        u64_map_add(mc->seen, blk, &first);
+    }
+    uint32_t *slot = (uint32_t*) u64_map_find(mc->slots, blk);
+    if (slot != NULL) {
+        //shadow hit, the block becomes the most recently used
+        uint32_t n = *slot;
+        list_unlink(mc, n);
+        list_push(mc, n);
+        return CONFLICT_MISS;
+    }
+    if (allocate) {
+        uint32_t n;
+        if (mc->used < mc->capacity) {
+            n = (uint32_t)mc->used++;
+        } else {
+            //replace the least recently used block
+            n = mc->tail;
+            list_unlink(mc, n);
+            u64_map_remove(mc->slots, mc->nodes[n].blk);
+        }
+        mc->nodes[n].blk = blk;
+        *(uint32_t*) u64_map_add(mc->slots, blk, NULL) = n;
+        list_push(mc, n);
+    }
+    return first ? COMPULSORY_MISS : CAPACITY_MISS;
+}
+
+/**
+ * Function to write the blocks brought in so far and the shadow blocks, least
+ * recently used first, to a checkpoint
+ *
+ */
+void classifier_save(FILE *f, const struct classifier *mc)
+{
+    uint64_t seen = u64_map_size(mc->seen);
+    checkpoint_put(f, &seen, sizeof(seen));
+    uint64_t pos = 0;
+    uint64_t blk;
+    while (u64_map_next(mc->seen, &pos, &blk) != NULL) {
+        checkpoint_put(f, &blk, sizeof(blk));
+    }
+    checkpoint_put(f, &mc->used, sizeof(uint64_t));
+    for (uint32_t n = mc->tail; n != NONE; n = mc->nodes[n].prev) {
+        checkpoint_put(f, &mc->nodes[n].blk, sizeof(uint64_t));
+    }
+}
+
+/**
+ * Function to load a checkpoint into an empty classifier of the same capacity
+ *
+ */
+void classifier_restore(FILE *f, struct classifier *mc)
+{
+    uint64_t seen = checkpoint_get_u64(f);
+    for (uint64_t i = 0; i < seen; i++) {
+        u64_map_add(mc->seen, checkpoint_get_u64(f), NULL);
+    }
+    uint64_t used = checkpoint_get_u64(f);
+    if (used > mc->capacity) {
+        fprintf(stderr, "Checkpoint has too many shadow blocks\n");
+        exit(EXIT_FAILURE);
+    }
+    //the last block brought in becomes the most recently used
+    for (uint64_t i = 0; i < used; i++) {
+        classifier_access(mc, checkpoint_get_u64(f), true);
+    }
+}
+
+void classifier_destroy(struct classifier *mc)
+{
+    if (mc == NULL) {
+        return;
+    }
+    u64_map_destroy(mc->seen);
+    free(mc->nodes);
+    u64_map_destroy(mc->slots);
+    free(mc);
+}
@@ -0,0 +1,28 @@
+/**
+ * @file classify.hpp
+ * @brief Compulsory, capacity and conflict miss classification for the cache simulator
+ *
+ * A classifier follows the demand accesses of one cache and tells what kind
+ * of miss each of its misses is. The cache keeps counting the misses itself.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+enum miss_class {COMPULSORY_MISS = 0, CAPACITY_MISS = 1, CONFLICT_MISS = 2};
+
+struct classifier;
+
+struct classifier* classifier_create(uint64_t blocks);
+enum miss_class classifier_access(struct classifier *mc, uint64_t blk, bool allocate);
+void classifier_save(FILE *f, const struct classifier *mc);
+void classifier_restore(FILE *f, struct classifier *mc);
+void classifier_destroy(struct classifier *mc);
+
+#endif // CLASSIFY_H
@@ -0,0 +1,72 @@
+/**
+ * @file coherence.cpp
+ * @brief MESI directory for the multi-core cache simulator
+ *
+ * One entry per block held by at least one core: a bit vector of sharers and
+ * the owner, the core holding the block in E or M (-1 while it is shared).
+ * Whether an owned block is E or M is the dirty bit of the owner's copy.
+ * Entries are removed as soon as the last sharer drops the block, so the
+ * directory tracks the private caches' contents and nothing more.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+
+#include "coherence.hpp"
+#include "u64_map.hpp"
+
+static const uint64_t DIRECTORY_INITIAL_ENTRIES = 1024;
+
+typedef struct dir_entry {
+    uint64_t sharers;   // one bit per core
+    int64_t owner;      // core holding the block in E or M, -1 if shared
+} dir_entry;
+
+struct directory {
+    struct u64_map* entries;    // by block number
+};
+
+struct directory* directory_create(void)
+{
+    struct directory *dir = (struct directory*) malloc(sizeof(struct directory));
+    dir->entries = u64_map_create(DIRECTORY_INITIAL_ENTRIES, sizeof(dir_entry));
+    return dir;
+}
+
+/**
+ * Function to look up the sharers of a block
+ * Returns the sharer bit vector, 0 if no core holds the block
+ *
+ */
+uint64_t directory_lookup(struct directory *dir, uint64_t blk, int64_t *owner)
+{
+    dir_entry *e = (dir_entry*) u64_map_find(dir->entries, blk);
+    *owner = e != NULL ? e->owner : -1;
+    return e != NULL ? e->sharers : 0;
+}
+
+/**
+ * Function to record the sharers and owner of a block, no sharers drops the entry
+ *
+ */
+void directory_update(struct directory *dir, uint64_t blk, uint64_t sharers, int64_t owner)
+{
+    if (sharers == 0) {
+        u64_map_remove(dir->entries, blk);
+        return;
+    }
+    dir_entry *e = (dir_entry*) u64_map_add(dir->entries, blk, NULL);
+    e->sharers = sharers;
+    e->owner = owner;
+}
+
+void directory_destroy(struct directory *dir)
+{
+    if (dir == NULL) {
+        return;
+    }
+    u64_map_destroy(dir->entries);
+    free(dir);
+}
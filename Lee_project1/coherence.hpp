@@ -0,0 +1,26 @@
+/**
+ * @file coherence.hpp
+ * @brief MESI directory for the multi-core cache simulator
+ *
+ * The directory only keeps the bookkeeping: which cores hold a block in their
+ * private levels and which core, if any, holds it exclusively (E or M). The
+ * cache hierarchy acts on it - invalidating, downgrading and forwarding blocks.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+struct directory;
+
+struct directory* directory_create(void);
+uint64_t directory_lookup(struct directory *dir, uint64_t blk, int64_t *owner);
+void directory_update(struct directory *dir, uint64_t blk, uint64_t sharers, int64_t owner);
+void directory_destroy(struct directory *dir);
+
+#endif // COHERENCE_H
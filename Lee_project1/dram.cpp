@@ -0,0 +1,228 @@
+/**
+ * @file dram.cpp
+ * @brief Main memory model for the cache simulator
+ *
+ * Every block read or written by the last level is turned into one DRAM request. The
+ * request is mapped to a channel, bank and row, waits for its bank and for the
+ * channel data bus, and pays a row hit, row miss or row conflict latency
+ * depending on the state of the bank's row buffer (open page policy).
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "dram.hpp"
+
+typedef struct bank {
+    bool open;          // row buffer holds a row
+    uint64_t row;       // currently open row
+    uint64_t ready;     // cycle the bank can start the next command
+} bank;
+
+typedef struct channel {
+    bank* banks;
+    uint64_t bus_free;  // cycle the data bus becomes free
+    uint64_t* queue;    // completion cycles of the requests in flight (ring)
+    uint64_t head;      // oldest request in the ring
+} channel;
+
+static channel* channels;
+static struct mem_config_t conf;
+static uint64_t blockBit;
+static uint64_t channelBit;
+static uint64_t bankBit;
+static uint64_t columnBit;
+
+static uint64_t log2_u64(uint64_t x) {
+    uint64_t bits = 0;
+    while (x > 1) {
+        x >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+static uint64_t take_bits(uint64_t *addr, uint64_t bits) {
+    uint64_t value = *addr & (((uint64_t)1 << bits) - 1);
+    *addr >>= bits;
+    return value;
+}
+
+/**
+ * Helper function to split a physical address into channel, bank and row
+ * according to the configured interleaving scheme
+ *
+ */
+static void dram_map(uint64_t addr, uint64_t *ch, uint64_t *ba, uint64_t *row) {
+    uint64_t blk = addr >> blockBit;
+    switch (conf.mapping) {
+        case RO_CO_BA_CH:
+            //consecutive blocks go to different channels, then banks
+            *ch = take_bits(&blk, channelBit);
+            *ba = take_bits(&blk, bankBit);
+            take_bits(&blk, columnBit);
+            *row = blk;
+            break;
+        case RO_BA_CH_CO:
+        case RO_BA_CH_CO_XOR:
+        default:
+            //consecutive blocks fill a row before moving to the next channel
+            take_bits(&blk, columnBit);
+            *ch = take_bits(&blk, channelBit);
+            *ba = take_bits(&blk, bankBit);
+            *row = blk;
+            if (conf.mapping == RO_BA_CH_CO_XOR) {
+                //permute the bank with the low row bits to spread row conflicts
+                *ba ^= *row & (conf.banks - 1);
+            }
+            break;
+    }
+}
+
+/**
+ * Function to initialize channels and banks
+ *
+ * @param sim_conf Pointer to simulation configuration structure
+ */
+void dram_init(struct sim_config_t *sim_conf)
+{
+    conf = sim_conf->mem;
+    blockBit = sim_conf->levels[sim_conf->num_levels - 1].data.b;
+    channelBit = log2_u64(conf.channels);
+    bankBit = log2_u64(conf.banks);
+    columnBit = conf.row_size > ((uint64_t)1 << blockBit) ? log2_u64(conf.row_size) - blockBit : 0;
+
+    channels = (channel*) malloc(conf.channels * sizeof(channel));
+    for (uint64_t i = 0; i < conf.channels; i++) {
+        channels[i].banks = (bank*) malloc(conf.banks * sizeof(bank));
+        for (uint64_t j = 0; j < conf.banks; j++) {
+            channels[i].banks[j].open = false;
+            channels[i].banks[j].row = 0;
+            channels[i].banks[j].ready = 0;
+        }
+        channels[i].bus_free = 0;
+        channels[i].queue = (uint64_t*) calloc(conf.queue_depth, sizeof(uint64_t));
+        channels[i].head = 0;
+    }
+}
+
+/**
+ * Function to perform one block transfer between the last level and DRAM
+ * Returns the latency of the request in cycles
+ *
+ * @param addr Address of the block
+ * @param write True for write backs and write throughs
+ * @param now Current cycle; moved forward when the channel queue is full
+ * @param sim_stats Pointer to simulation statistics structure
+ */
+uint64_t dram_access(uint64_t addr, bool write, uint64_t *now, struct sim_stats_t *sim_stats)
+{
+    uint64_t ch, ba, row;
+    dram_map(addr, &ch, &ba, &row);
+    channel *c = &channels[ch];
+    bank *b = &c->banks[ba];
+
+    //the queue is full until its oldest request completes, stall the requester
+    uint64_t arrive = *now;
+    if (c->queue[c->head] > *now) {
+        sim_stats->mem_num_queue_stalls++;
+        *now = c->queue[c->head];
+    }
+
+    uint64_t start = b->ready > *now ? b->ready : *now;
+    uint64_t latency;
+    if (b->open && b->row == row) {
+        sim_stats->mem_num_row_hits++;
+        latency = conf.row_hit_time;
+    }
+    else if (!b->open) {
+        sim_stats->mem_num_row_misses++;
+        latency = conf.row_miss_time;
+    }
+    else {
+        sim_stats->mem_num_row_conflicts++;
+        latency = conf.row_conflict_time;
+    }
+    b->open = true;
+    b->row = row;
+    b->ready = start + latency;
+
+    //transfer the block over the channel data bus
+    uint64_t transfer = b->ready > c->bus_free ? b->ready : c->bus_free;
+    uint64_t done = transfer + conf.bus_time;
+    c->bus_free = done;
+    c->queue[c->head] = done;
+    c->head = (c->head + 1) % conf.queue_depth;
+
+    sim_stats->mem_queue_cycles += (start - arrive) + (transfer - b->ready);
+    if (write) {
+        sim_stats->mem_num_writes++;
+    }
+    else {
+        sim_stats->mem_num_reads++;
+        sim_stats->mem_read_cycles += done - arrive;
+    }
+    return done - arrive;
+}
+
+/**
+ * Function to write the geometry and the bank, bus and queue state of every channel to a checkpoint
+ *
+ */
+void dram_save(FILE *f)
+{
+    uint64_t geometry[3] = {conf.channels, conf.banks, conf.queue_depth};
+    checkpoint_put(f, geometry, sizeof(geometry));
+    for (uint64_t i = 0; i < conf.channels; i++) {
+        checkpoint_put(f, channels[i].banks, conf.banks * sizeof(bank));
+        uint64_t state[2] = {channels[i].bus_free, channels[i].head};
+        checkpoint_put(f, state, sizeof(state));
+        checkpoint_put(f, channels[i].queue, conf.queue_depth * sizeof(uint64_t));
+    }
+}
+
+/**
+ * Function to load a checkpoint into channels of the same geometry
+ *
+ */
+void dram_restore(FILE *f)
+{
+    uint64_t geometry[3];
+    checkpoint_get(f, geometry, sizeof(geometry));
+    if (geometry[0] != conf.channels || geometry[1] != conf.banks || geometry[2] != conf.queue_depth) {
+        fprintf(stderr, "Checkpoint is of a different main memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint64_t i = 0; i < conf.channels; i++) {
+        checkpoint_get(f, channels[i].banks, conf.banks * sizeof(bank));
+        channels[i].bus_free = checkpoint_get_u64(f);
+        channels[i].head = checkpoint_get_u64(f);
+        checkpoint_get(f, channels[i].queue, conf.queue_depth * sizeof(uint64_t));
+    }
+}
+
+/**
+ * Function to free the DRAM model and compute the memory statistics
+ *
+ * @param sim_stats Pointer to simulation statistics structure
+ */
+void dram_cleanup(struct sim_stats_t *sim_stats)
+{
+    uint64_t requests = sim_stats->mem_num_reads + sim_stats->mem_num_writes;
+    if (requests) {
+        sim_stats->mem_row_hit_rate = (double)sim_stats->mem_num_row_hits / (double)requests;
+        sim_stats->mem_avg_queue_delay = (double)sim_stats->mem_queue_cycles / (double)requests;
+    }
+    if (sim_stats->mem_num_reads) {
+        sim_stats->mem_avg_read_latency = (double)sim_stats->mem_read_cycles / (double)sim_stats->mem_num_reads;
+    }
+
+    for (uint64_t i = 0; i < conf.channels; i++) {
+        free(channels[i].banks);
+        free(channels[i].queue);
+    }
+    free(channels);
+}
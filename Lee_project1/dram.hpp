@@ -0,0 +1,24 @@
+/**
+ * @file dram.hpp
+ * @brief Main memory model for the cache simulator
+ *
+ * Models channels, banks with an open row buffer, an address interleaving
+ * scheme and a per-channel request queue limited by the data bus bandwidth.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef DRAM_H
+#define DRAM_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+void dram_init(struct sim_config_t *sim_conf);
+uint64_t dram_access(uint64_t addr, bool write, uint64_t *now, struct sim_stats_t *sim_stats);
+void dram_save(FILE *f);
+void dram_restore(FILE *f);
+void dram_cleanup(struct sim_stats_t *sim_stats);
+
+#endif // DRAM_H
@@ -0,0 +1,175 @@
+/**
+ * @file events.cpp
+ * @brief Binary event log of cache activity for the cache simulator
+ *
+ * A thread fills its own chunk of events without locking. A full chunk is
+ * queued for the writer thread and the thread takes a free one, waiting only
+ * when all EVENT_CHUNKS chunks are queued. A thread other than the one that
+ * closes the log calls event_log_flush before it stops logging.
+ *
+ * The file starts with the magic "CSEV", a uint32 version, a uint32 record
+ * size and a uint32 cache count, then one uint8 level per cache, followed by
+ * struct event_record_t records.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "events.hpp"
+
+static const uint64_t EVENT_CHUNK = 4096;
+static const uint64_t EVENT_CHUNKS = 8;
+static const uint32_t BINARY_VERSION = 1;
+
+typedef struct event_chunk {
+    struct event_record_t events[EVENT_CHUNK];
+    uint64_t used;
+} event_chunk;
+
+struct event_log {
+    FILE* out;
+    event_chunk* chunks;
+    event_chunk* free_list[EVENT_CHUNKS];   // chunks no thread is filling
+    uint64_t num_free;
+    event_chunk* queue[EVENT_CHUNKS];       // full chunks waiting for the writer (ring)
+    uint64_t head;
+    uint64_t queued;
+    bool closing;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;      // a chunk was queued or the log is closing
+    pthread_cond_t freed;       // a chunk was written
+    pthread_t writer;
+};
+
+// Chunk the thread is filling and the log it belongs to
+static thread_local event_chunk* current = NULL;
+static thread_local struct event_log* current_log = NULL;
+
+static void* event_writer(void *arg) {
+    struct event_log *log = (struct event_log*) arg;
+    pthread_mutex_lock(&log->lock);
+    while (true) {
+        while (log->queued == 0 && !log->closing) {
+            pthread_cond_wait(&log->filled, &log->lock);
+        }
+        if (log->queued == 0) {
+            break;
+        }
+        event_chunk *chunk = log->queue[log->head];
+        log->head = (log->head + 1) % EVENT_CHUNKS;
+        log->queued--;
+        //write without holding the lock so the simulation keeps going
+        pthread_mutex_unlock(&log->lock);
+        fwrite(chunk->events, sizeof(struct event_record_t), chunk->used, log->out);
+        chunk->used = 0;
+        pthread_mutex_lock(&log->lock);
+        log->free_list[log->num_free++] = chunk;
+        pthread_cond_signal(&log->freed);
+    }
+    pthread_mutex_unlock(&log->lock);
+    return NULL;
+}
+
+/**
+ * Function to queue the chunk of the thread for writing and optionally take a free one
+ *
+ */
+static void chunk_swap(struct event_log *log, bool take) {
+    pthread_mutex_lock(&log->lock);
+    if (current != NULL && current_log == log) {
+        log->queue[(log->head + log->queued) % EVENT_CHUNKS] = current;
+        log->queued++;
+        pthread_cond_signal(&log->filled);
+    }
+    current = NULL;
+    current_log = log;
+    if (take) {
+        while (log->num_free == 0) {
+            pthread_cond_wait(&log->freed, &log->lock);
+        }
+        current = log->free_list[--log->num_free];
+    }
+    pthread_mutex_unlock(&log->lock);
+}
+
+struct event_log* event_log_open(const char *file, uint64_t num_caches, const uint8_t *levels)
+{
+    struct event_log *log = (struct event_log*) calloc(1, sizeof(struct event_log));
+    log->out = fopen(file, "wb");
+    if (log->out == NULL) {
+        fprintf(stderr, "Could not open the event log %s\n", file);
+        exit(EXIT_FAILURE);
+    }
+    uint32_t header[3] = {BINARY_VERSION, (uint32_t)sizeof(struct event_record_t), (uint32_t)num_caches};
+    fwrite("CSEV", 1, 4, log->out);
+    fwrite(header, sizeof(uint32_t), 3, log->out);
+    fwrite(levels, sizeof(uint8_t), num_caches, log->out);
+
+    log->chunks = (event_chunk*) calloc(EVENT_CHUNKS, sizeof(event_chunk));
+    for (uint64_t i = 0; i < EVENT_CHUNKS; i++) {
+        log->free_list[log->num_free++] = &log->chunks[i];
+    }
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->filled, NULL);
+    pthread_cond_init(&log->freed, NULL);
+    pthread_create(&log->writer, NULL, event_writer, log);
+    return log;
+}
+
+/**
+ * Function to add one event to the chunk of the calling thread
+ *
+ */
+void event_record(struct event_log *log, enum event_kind kind, uint64_t seq, uint64_t cache, uint64_t level,
+                  uint64_t set, uint64_t way, uint64_t tag)
+{
+    if (current == NULL || current_log != log || current->used == EVENT_CHUNK) {
+        chunk_swap(log, true);
+    }
+    struct event_record_t *e = &current->events[current->used++];
+    e->seq = seq;
+    e->tag = tag;
+    e->set = (uint32_t)set;
+    e->way = way > 0xffff ? 0xffff : (uint16_t)way;
+    e->cache = (uint16_t)cache;
+    e->kind = (uint8_t)kind;
+    e->level = (uint8_t)level;
+}
+
+/**
+ * Function to hand the events of the calling thread to the writer
+ *
+ */
+void event_log_flush(struct event_log *log)
+{
+    if (current != NULL && current_log == log) {
+        chunk_swap(log, false);
+    }
+}
+
+/**
+ * Function to write every event still held and close the log
+ *
+ */
+void event_log_close(struct event_log *log)
+{
+    if (log == NULL) {
+        return;
+    }
+    event_log_flush(log);
+    pthread_mutex_lock(&log->lock);
+    log->closing = true;
+    pthread_cond_signal(&log->filled);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->writer, NULL);
+    fclose(log->out);
+    pthread_mutex_destroy(&log->lock);
+    pthread_cond_destroy(&log->filled);
+    pthread_cond_destroy(&log->freed);
+    free(log->chunks);
+    free(log);
+}
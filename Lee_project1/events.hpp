@@ -0,0 +1,44 @@
+/**
+ * @file events.hpp
+ * @brief Binary event log of cache activity for the cache simulator
+ *
+ * The caches report hits, misses, fills, evictions, dirty write backs, LFU
+ * protection of a just filled block and stores written through. Events are
+ * gathered in per-thread chunks and written to the log file by a writer
+ * thread, so the simulation never waits on the file unless every chunk is
+ * still being written.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+enum event_kind {EVENT_HIT = 0, EVENT_MISS = 1, EVENT_FILL = 2, EVENT_EVICT = 3, EVENT_WRITE_BACK = 4,
+                 EVENT_LFU_PROTECT = 5, EVENT_WRITE_THROUGH = 6};
+
+// One event as written to the log, little endian
+struct event_record_t {
+    uint64_t seq;       // core access that caused the event, from 0
+    uint64_t tag;
+    uint32_t set;       // row of the block, or the set looked up
+    uint16_t way;       // 0xffff when the event has no way, like a miss
+    uint16_t cache;     // cache id, in the order of the statistics
+    uint8_t kind;       // enum event_kind
+    uint8_t level;      // 0 is closest to the core
+    uint8_t unused[6];
+};
+
+struct event_log;
+
+struct event_log* event_log_open(const char *file, uint64_t num_caches, const uint8_t *levels);
+void event_record(struct event_log *log, enum event_kind kind, uint64_t seq, uint64_t cache, uint64_t level,
+                  uint64_t set, uint64_t way, uint64_t tag);
+void event_log_flush(struct event_log *log);
+void event_log_close(struct event_log *log);
+
+#endif // EVENTS_H
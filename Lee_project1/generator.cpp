@@ -0,0 +1,210 @@
+/**
+ * @file generator.cpp
+ * @brief Synthetic access streams for the cache simulator
+ *
+ * The cores take turns issuing accesses, each from a stream of its own seeded
+ * with the seed plus its ID. An access is an instruction, load or store drawn
+ * by the mix weights. Instructions run through a loop of code_size bytes and
+ * data accesses follow the pattern inside the working set:
+ *  - sequential: the next element, size bytes or 8 if no size is given
+ *  - strided: stride bytes on
+ *  - uniform: any element of the working set
+ *  - Zipf: block k of the working set with probability proportional to
+ *    1 / k^exponent, drawn by rejection-inversion (Hoermann and Derflinger)
+ *    so no table of the blocks is needed
+ *  - pointer chase: the next block of a random cycle through every block,
+ *    the same cycle for every core
+ * Sequential and strided streams of different cores start spread out over
+ * the working set.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "generator.hpp"
+
+static const uint64_t CODE_BASE = 0x400000;
+static const uint64_t DATA_BASE = 0x10000000;
+static const uint64_t INST_BYTES = 4;
+static const uint64_t BLOCK_BYTES = 64;         // granularity of Zipf and pointer chase blocks
+static const uint64_t MAX_CHASE_BLOCKS = (uint64_t)1 << 32;
+
+typedef struct stream {
+    uint64_t rng;
+    uint64_t pc;        // offset of the next instruction in the loop
+    uint64_t offset;    // offset of the last data access in the working set
+} stream;
+
+struct generator {
+    struct generator_config_t conf;
+    uint64_t cores;
+    uint64_t issued;
+    uint64_t blocks;    // blocks of the working set
+    uint64_t element;   // bytes of a sequential or uniform element
+    uint32_t* next;     // pointer chase cycle, pointer chase only
+    stream* streams;
+    // Zipf sampler constants
+    double h_x1;
+    double h_n;
+    double s;
+};
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double uniform01(uint64_t *state) {
+    return (double)(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Uniform in [0, n)
+static uint64_t uniform_below(uint64_t *state, uint64_t n) {
+    return (uint64_t)(uniform01(state) * (double)n);
+}
+
+// log(1 + x) / x and (exp(x) - 1) / x, both 1 at 0
+static double helper1(double x) {
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x / 2.0;
+}
+static double helper2(double x) {
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x / 2.0;
+}
+
+// Zipf density h(x) = x^-exponent, its integral H and the inverse of H
+static double zipf_h(const struct generator *g, double x) {
+    return exp(-g->conf.zipf_exponent * log(x));
+}
+static double zipf_H(const struct generator *g, double x) {
+    double log_x = log(x);
+    return helper2((1.0 - g->conf.zipf_exponent) * log_x) * log_x;
+}
+static double zipf_H_inverse(const struct generator *g, double x) {
+    double t = x * (1.0 - g->conf.zipf_exponent);
+    if (t < -1.0) {
+        t = -1.0;
+    }
+    return exp(helper1(t) * x);
+}
+
+/**
+ * Function to draw a Zipf distributed block
+ * Returns a block of the working set, 0 the most likely one
+ *
+ */
+static uint64_t zipf_block(struct generator *g, uint64_t *rng) {
+    while (true) {
+        double u = g->h_n + uniform01(rng) * (g->h_x1 - g->h_n);
+        double x = zipf_H_inverse(g, u);
+        double k = floor(x + 0.5);
+        if (k < 1) {
+            k = 1;
+        } else if (k > (double)g->blocks) {
+            k = (double)g->blocks;
+        }
+        if (k - x <= g->s || u >= zipf_H(g, k + 0.5) - zipf_h(g, k)) {
+            return (uint64_t)k - 1;
+        }
+    }
+}
+
+struct generator* generator_create(const struct generator_config_t *conf, uint64_t cores)
+{
+    struct generator *g = (struct generator*) calloc(1, sizeof(struct generator));
+    g->conf = *conf;
+    g->cores = cores;
+    g->blocks = conf->working_set / BLOCK_BYTES ? conf->working_set / BLOCK_BYTES : 1;
+    g->element = conf->size ? conf->size : 8;
+    g->streams = (stream*) calloc(cores, sizeof(stream));
+    for (uint64_t core = 0; core < cores; core++) {
+        g->streams[core].rng = conf->seed + core;
+        g->streams[core].offset = conf->working_set / cores * core;
+    }
+    if (conf->pattern == GEN_ZIPF) {
+        g->h_x1 = zipf_H(g, 1.5) - 1.0;
+        g->h_n = zipf_H(g, (double)g->blocks + 0.5);
+        g->s = 2.0 - zipf_H_inverse(g, zipf_H(g, 2.5) - zipf_h(g, 2.0));
+    }
+    if (conf->pattern == GEN_POINTER_CHASE) {
+        if (g->blocks > MAX_CHASE_BLOCKS) {
+            fprintf(stderr, "Pointer chase working set too big\n");
+            exit(EXIT_FAILURE);
+        }
+        //Sattolo's shuffle gives a single cycle through every block
+        uint64_t rng = conf->seed;
+        g->next = (uint32_t*) malloc(g->blocks * sizeof(uint32_t));
+        for (uint64_t i = 0; i < g->blocks; i++) {
+            g->next[i] = (uint32_t)i;
+        }
+        for (uint64_t i = g->blocks - 1; i > 0; i--) {
+            uint64_t j = uniform_below(&rng, i);
+            uint32_t tmp = g->next[i];
+            g->next[i] = g->next[j];
+            g->next[j] = tmp;
+        }
+        for (uint64_t core = 0; core < cores; core++) {
+            g->streams[core].offset = g->blocks / cores * core * BLOCK_BYTES;
+        }
+    }
+    return g;
+}
+
+/**
+ * Function to generate the next access
+ * Returns false once the configured number of accesses was generated
+ *
+ */
+bool generator_next(struct generator *g, uint64_t *core, char *type, uint64_t *addr, uint64_t *size)
+{
+    if (g->issued == g->conf.accesses) {
+        return false;
+    }
+    *core = g->issued++ % g->cores;
+    stream *st = &g->streams[*core];
+    *size = g->conf.size;
+
+    uint64_t pick = uniform_below(&st->rng, g->conf.mix[0] + g->conf.mix[1] + g->conf.mix[2]);
+    if (pick < g->conf.mix[0]) {
+        *type = INST;
+        *addr = CODE_BASE + st->pc;
+        st->pc = (st->pc + INST_BYTES) % g->conf.code_size;
+        return true;
+    }
+    *type = pick < g->conf.mix[0] + g->conf.mix[1] ? LOAD : STORE;
+    switch (g->conf.pattern) {
+        case GEN_SEQUENTIAL:
+            st->offset = (st->offset + g->element) % g->conf.working_set;
+            break;
+        case GEN_STRIDED:
+            st->offset = (st->offset + g->conf.stride) % g->conf.working_set;
+            break;
+        case GEN_UNIFORM:
+            st->offset = uniform_below(&st->rng, g->conf.working_set / g->element) * g->element;
+            break;
+        case GEN_ZIPF:
+            st->offset = zipf_block(g, &st->rng) * BLOCK_BYTES;
+            break;
+        case GEN_POINTER_CHASE:
+            st->offset = (uint64_t)g->next[st->offset / BLOCK_BYTES] * BLOCK_BYTES;
+            break;
+    }
+    *addr = DATA_BASE + st->offset;
+    return true;
+}
+
+void generator_destroy(struct generator *g)
+{
+    if (g == NULL) {
+        return;
+    }
+    free(g->next);
+    free(g->streams);
+    free(g);
+}
@@ -0,0 +1,26 @@
+/**
+ * @file generator.hpp
+ * @brief Synthetic access streams for the cache simulator
+ *
+ * A generator stands in for a trace: sequential, strided, uniform random,
+ * Zipfian and pointer chasing data accesses mixed with instruction fetches,
+ * loads and stores in configured proportions. The same seed always gives the
+ * same accesses.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+struct generator;
+
+struct generator* generator_create(const struct generator_config_t *conf, uint64_t cores);
+bool generator_next(struct generator *g, uint64_t *core, char *type, uint64_t *addr, uint64_t *size);
+void generator_destroy(struct generator *g);
+
+#endif // GENERATOR_H
@@ -0,0 +1,227 @@
+/**
+ * @file prefetch.cpp
+ * @brief Hardware prefetchers for the cache simulator
+ *
+ * All prefetchers work on block numbers (address >> B) and are trained only
+ * on misses and on the first demand hit to a prefetched block, so a cache that
+ * mostly hits pays nothing for having one attached.
+ *
+ *  - Next line: requests the blocks following the trigger.
+ *  - Stride: a table of streams indexed by 4KiB region. Once the same block
+ *    stride is seen twice in a region, the blocks along the stride are requested.
+ *  - Stream buffer: tracks a few ascending streams allocated on misses. A
+ *    trigger inside a stream's window advances it and tops the stream up.
+ *    Prefetched blocks are placed in the cache rather than in separate buffers.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+
+#include "prefetch.hpp"
+
+static const uint64_t STRIDE_ENTRIES = 64;
+static const uint64_t STRIDE_REGION_BITS = 12;
+static const uint64_t STREAM_ENTRIES = 8;
+static const uint64_t FILTER_ENTRIES = 1024;
+
+typedef struct stride_entry {
+    bool valid;
+    uint64_t region;
+    uint64_t last;      // last block seen in the region
+    int64_t stride;
+    uint64_t confidence;
+} stride_entry;
+
+typedef struct stream_entry {
+    bool valid;
+    uint64_t head;      // next block the program is expected to miss on
+    uint64_t tail;      // next block the stream will request
+    uint64_t history;   // for LRU allocation
+} stream_entry;
+
+struct prefetcher {
+    enum prefetch_policy policy;
+    uint64_t degree;
+    uint64_t distance;
+    uint64_t regionShift;   // block number to 4KiB region
+    stride_entry* strides;
+    stream_entry* streams;
+    uint64_t count;
+    uint64_t* filter;   // blocks evicted by prefetch fills, offset by one so 0 is empty
+};
+
+/**
+ * Function to allocate a prefetcher for a cache
+ * Returns NULL if the cache has no prefetcher
+ *
+ */
+struct prefetcher* prefetch_create(const struct cache_config_t *conf)
+{
+    if (conf->pf == NO_PREFETCH) {
+        return NULL;
+    }
+    struct prefetcher *pf = (struct prefetcher*) malloc(sizeof(struct prefetcher));
+    pf->policy = conf->pf;
+    pf->degree = conf->pf_degree > MAX_PREFETCH_DEGREE ? MAX_PREFETCH_DEGREE : conf->pf_degree;
+    pf->distance = conf->pf_distance;
+    pf->regionShift = conf->b < STRIDE_REGION_BITS ? STRIDE_REGION_BITS - conf->b : 0;
+    pf->strides = (stride_entry*) calloc(STRIDE_ENTRIES, sizeof(stride_entry));
+    pf->streams = (stream_entry*) calloc(STREAM_ENTRIES, sizeof(stream_entry));
+    pf->count = 0;
+    pf->filter = (uint64_t*) calloc(FILTER_ENTRIES, sizeof(uint64_t));
+    return pf;
+}
+
+static uint64_t train_stride(struct prefetcher *pf, uint64_t blk, uint64_t *candidates) {
+    uint64_t region = blk >> pf->regionShift;
+    stride_entry *e = &pf->strides[(region ^ (region >> 6)) % STRIDE_ENTRIES];
+    if (!e->valid || e->region != region) {
+        e->valid = true;
+        e->region = region;
+        e->last = blk;
+        e->stride = 0;
+        e->confidence = 0;
+        return 0;
+    }
+    int64_t stride = (int64_t)(blk - e->last);
+    if (stride == 0) {
+        return 0;
+    }
+    if (stride == e->stride) {
+        if (e->confidence < 3) {
+            e->confidence++;
+        }
+    }
+    else {
+        e->stride = stride;
+        e->confidence = 0;
+    }
+    e->last = blk;
+    if (e->confidence < 1) {
+        return 0;
+    }
+    uint64_t n = 0;
+    for (uint64_t i = 0; i < pf->degree; i++) {
+        int64_t next = (int64_t)blk + stride * (int64_t)(pf->distance + i);
+        if (next >= 0) {
+            candidates[n++] = (uint64_t)next;
+        }
+    }
+    return n;
+}
+
+static uint64_t train_stream(struct prefetcher *pf, uint64_t blk, uint64_t *candidates) {
+    stream_entry *s = NULL;
+    pf->count++;
+    for (uint64_t i = 0; i < STREAM_ENTRIES; i++) {
+        stream_entry *e = &pf->streams[i];
+        if (e->valid && blk >= e->head && blk < e->tail) {
+            s = e;
+            break;
+        }
+    }
+    if (s == NULL) {
+        //allocate the least recently used stream
+        s = &pf->streams[0];
+        for (uint64_t i = 1; i < STREAM_ENTRIES && s->valid; i++) {
+            if (!pf->streams[i].valid || pf->streams[i].history < s->history) {
+                s = &pf->streams[i];
+            }
+        }
+        s->valid = true;
+        s->tail = blk + pf->distance;
+    }
+    s->head = blk + 1;
+    s->history = pf->count;
+
+    //keep degree blocks requested beyond the distance window, skipping the
+    //part of the window a stream that fell behind never requested
+    if (s->tail < blk + pf->distance) {
+        s->tail = blk + pf->distance;
+    }
+    uint64_t n = 0;
+    uint64_t limit = blk + pf->distance + pf->degree;
+    for (; s->tail < limit && n < pf->degree; s->tail++) {
+        candidates[n++] = s->tail;
+    }
+    return n;
+}
+
+/**
+ * Function to train a prefetcher on a trigger block
+ * Returns the number of block numbers written to candidates
+ *
+ * @param pf The prefetcher
+ * @param blk Block number of the miss or prefetched-block hit
+ * @param candidates Room for MAX_PREFETCH_DEGREE block numbers to prefetch
+ */
+uint64_t prefetch_train(struct prefetcher *pf, uint64_t blk, uint64_t *candidates)
+{
+    switch (pf->policy) {
+        case NEXT_LINE:
+            for (uint64_t i = 0; i < pf->degree; i++) {
+                candidates[i] = blk + pf->distance + i;
+            }
+            return pf->degree;
+        case STRIDE:
+            return train_stride(pf, blk, candidates);
+        case STREAM_BUFFER:
+            return train_stream(pf, blk, candidates);
+        case NO_PREFETCH:
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Function to remember a block that a prefetch fill evicted
+ *
+ */
+void prefetch_evicted(struct prefetcher *pf, uint64_t blk)
+{
+    pf->filter[blk % FILTER_ENTRIES] = blk + 1;
+}
+
+/**
+ * Function to check whether a demand miss is on a block a prefetch fill evicted
+ * Returns true only once per eviction
+ *
+ */
+bool prefetch_polluted(struct prefetcher *pf, uint64_t blk)
+{
+    if (pf->filter[blk % FILTER_ENTRIES] == blk + 1) {
+        pf->filter[blk % FILTER_ENTRIES] = 0;
+        return true;
+    }
+    return false;
+}
+
+// Write the tables of a prefetcher to a checkpoint and load them into one of the same policy
+void prefetch_save(FILE *f, const struct prefetcher *pf)
+{
+    checkpoint_put(f, pf->strides, STRIDE_ENTRIES * sizeof(stride_entry));
+    checkpoint_put(f, pf->streams, STREAM_ENTRIES * sizeof(stream_entry));
+    checkpoint_put(f, &pf->count, sizeof(uint64_t));
+    checkpoint_put(f, pf->filter, FILTER_ENTRIES * sizeof(uint64_t));
+}
+
+void prefetch_restore(FILE *f, struct prefetcher *pf)
+{
+    checkpoint_get(f, pf->strides, STRIDE_ENTRIES * sizeof(stride_entry));
+    checkpoint_get(f, pf->streams, STREAM_ENTRIES * sizeof(stream_entry));
+    pf->count = checkpoint_get_u64(f);
+    checkpoint_get(f, pf->filter, FILTER_ENTRIES * sizeof(uint64_t));
+}
+
+void prefetch_destroy(struct prefetcher *pf)
+{
+    if (pf == NULL) {
+        return;
+    }
+    free(pf->strides);
+    free(pf->streams);
+    free(pf->filter);
+    free(pf);
+}
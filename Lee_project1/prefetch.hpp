@@ -0,0 +1,29 @@
+/**
+ * @file prefetch.hpp
+ * @brief Hardware prefetchers for the cache simulator
+ *
+ * A prefetcher only decides which blocks to request. The cache it is attached
+ * to trains it on misses and first hits to prefetched blocks, and performs the
+ * fills itself.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+struct prefetcher;
+
+struct prefetcher* prefetch_create(const struct cache_config_t *conf);
+uint64_t prefetch_train(struct prefetcher *pf, uint64_t blk, uint64_t *candidates);
+void prefetch_evicted(struct prefetcher *pf, uint64_t blk);
+bool prefetch_polluted(struct prefetcher *pf, uint64_t blk);
+void prefetch_save(FILE *f, const struct prefetcher *pf);
+void prefetch_restore(FILE *f, struct prefetcher *pf);
+void prefetch_destroy(struct prefetcher *pf);
+
+#endif // PREFETCH_H
@@ -0,0 +1,121 @@
+/**
+ * @file scheduler.cpp
+ * @brief Deterministic interleaving of per-core traces
+ *
+ * Every core has a clock and the core with the earliest clock issues next,
+ * ties going to the lowest core ID, so a run never depends on anything but its
+ * inputs. The caller advances the clock of the core it just ran: by one for
+ * round robin, or by the time the access kept the core busy. The cores wait in
+ * a binary heap, so picking the next one costs O(log cores).
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+
+#include "scheduler.hpp"
+
+struct scheduler {
+    uint64_t* time;     // clock of every core
+    uint64_t* heap;     // cores waiting to issue, earliest clock first
+    uint64_t n;         // cores in the heap
+    uint64_t cores;
+};
+
+static bool earlier(struct scheduler *s, uint64_t a, uint64_t b) {
+    return s->time[a] < s->time[b] || (s->time[a] == s->time[b] && a < b);
+}
+
+static void sift_up(struct scheduler *s, uint64_t i) {
+    while (i > 0 && earlier(s, s->heap[i], s->heap[(i - 1) / 2])) {
+        uint64_t tmp = s->heap[i];
+        s->heap[i] = s->heap[(i - 1) / 2];
+        s->heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static void sift_down(struct scheduler *s, uint64_t i) {
+    while (true) {
+        uint64_t first = i;
+        if (2 * i + 1 < s->n && earlier(s, s->heap[2 * i + 1], s->heap[first]))
+            first = 2 * i + 1;
+        if (2 * i + 2 < s->n && earlier(s, s->heap[2 * i + 2], s->heap[first]))
+            first = 2 * i + 2;
+        if (first == i)
+            return;
+        uint64_t tmp = s->heap[i];
+        s->heap[i] = s->heap[first];
+        s->heap[first] = tmp;
+        i = first;
+    }
+}
+
+struct scheduler* scheduler_create(uint64_t cores)
+{
+    struct scheduler *s = (struct scheduler*) malloc(sizeof(struct scheduler));
+    s->time = (uint64_t*) calloc(cores, sizeof(uint64_t));
+    s->heap = (uint64_t*) malloc(cores * sizeof(uint64_t));
+    s->n = cores;
+    s->cores = cores;
+    for (uint64_t i = 0; i < cores; i++) {
+        s->heap[i] = i;
+    }
+    return s;
+}
+
+/**
+ * Function to take the core that issues next out of the scheduler
+ * It stays out until it is advanced, a core whose trace ended is just never advanced
+ * Returns false once no core is left
+ *
+ */
+bool scheduler_next(struct scheduler *s, uint64_t *core)
+{
+    if (s->n == 0) {
+        return false;
+    }
+    *core = s->heap[0];
+    s->heap[0] = s->heap[--s->n];
+    sift_down(s, 0);
+    return true;
+}
+
+/**
+ * Function to put a core back with its clock moved forward
+ *
+ */
+void scheduler_advance(struct scheduler *s, uint64_t core, uint64_t delta)
+{
+    s->time[core] += delta;
+    s->heap[s->n] = core;
+    sift_up(s, s->n++);
+}
+
+uint64_t scheduler_time(const struct scheduler *s, uint64_t core)
+{
+    return s->time[core];
+}
+
+/**
+ * Function to put every core back with the clock it had in an earlier run
+ * The order only depends on the clocks, a core whose trace ended drops out again
+ *
+ */
+void scheduler_restart(struct scheduler *s, const uint64_t *time)
+{
+    s->n = 0;
+    for (uint64_t i = 0; i < s->cores; i++) {
+        s->time[i] = time[i];
+        s->heap[s->n] = i;
+        sift_up(s, s->n++);
+    }
+}
+
+void scheduler_destroy(struct scheduler *s)
+{
+    free(s->time);
+    free(s->heap);
+    free(s);
+}
@@ -0,0 +1,24 @@
+/**
+ * @file scheduler.hpp
+ * @brief Deterministic interleaving of per-core traces
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+struct scheduler;
+
+struct scheduler* scheduler_create(uint64_t cores);
+bool scheduler_next(struct scheduler *s, uint64_t *core);
+void scheduler_advance(struct scheduler *s, uint64_t core, uint64_t delta);
+uint64_t scheduler_time(const struct scheduler *s, uint64_t core);
+void scheduler_restart(struct scheduler *s, const uint64_t *time);
+void scheduler_destroy(struct scheduler *s);
+
+#endif // SCHEDULER_H
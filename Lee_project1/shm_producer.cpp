@@ -0,0 +1,77 @@
+/**
+ * @file shm_producer.cpp
+ * @brief Reference producer of a shared memory ring for the cache simulator
+ *
+ * Streams a trace file into a ring the way an instrumentation tool would
+ * stream the accesses of a running workload:
+ *     ./shm_producer <ring name> <trace file> [ring records]
+ *     ./cachesim -c <configuration file> -s <ring name>
+ * Build it on its own: g++ -O2 shm_producer.cpp shm_ring.cpp -o shm_producer
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "shm_ring.hpp"
+
+static const uint64_t BATCH = 256;
+static const uint64_t DEFAULT_RECORDS = 1 << 16;
+
+// Parse one trace line, "<type> <address>" or "<core> <type> <address>",
+// either followed by an optional size in bytes
+static bool parse_line(const char *line, struct shm_record *r)
+{
+    uint64_t core = 0, addr, size = 0;
+    char type;
+    if (line[0] >= '0' && line[0] <= '9') {
+        if (sscanf(line, "%" SCNu64 " %c %" SCNx64 " %" SCNu64, &core, &type, &addr, &size) < 3) {
+            return false;
+        }
+    } else if (sscanf(line, "%c %" SCNx64 " %" SCNu64, &type, &addr, &size) < 2) {
+        return false;
+    }
+    r->addr = addr;
+    r->size = (uint32_t)size;
+    r->type = (uint8_t)type;
+    r->core = (uint8_t)core;
+    r->unused = 0;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "./shm_producer <ring name> <trace file> [ring records]\n");
+        return EXIT_FAILURE;
+    }
+    FILE *trace = fopen(argv[2], "r");
+    if (trace == NULL) {
+        fprintf(stderr, "Could not open the trace file %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    struct shm_ring *ring = shm_ring_create(argv[1], argc > 3 ? strtoull(argv[3], NULL, 10) : DEFAULT_RECORDS);
+
+    struct shm_record batch[BATCH];
+    uint64_t n = 0;
+    uint64_t total = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), trace) != NULL) {
+        if (!parse_line(line, &batch[n])) {
+            continue;
+        }
+        if (++n == BATCH) {
+            shm_ring_write(ring, batch, n);
+            total += n;
+            n = 0;
+        }
+    }
+    shm_ring_write(ring, batch, n);
+    total += n;
+    shm_ring_close(ring);
+    fclose(trace);
+    fprintf(stderr, "%" PRIu64 " accesses produced\n", total);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file shm_ring.cpp
+ * @brief Shared memory ring of accesses from a live trace producer
+ *
+ * Both sides copy a whole batch before moving their index, so an index is
+ * written once per batch and not per record. A side that finds the ring full
+ * or empty spins for a while and then sleeps between checks, which keeps a
+ * stalled side off the CPU without adding latency to a busy ring.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shm_ring.hpp"
+
+static const uint32_t RING_VERSION = 1;
+static const uint64_t SPINS = 1024;             // checks before the waiting side sleeps
+static const long SLEEP_NS = 50000;
+static const uint64_t ATTACH_TRIES = 200;       // sleeps of ATTACH_SLEEP_NS for the producer to appear
+static const long ATTACH_SLEEP_NS = 50000000;
+static const uint64_t PRODUCER_CHECK = 2000;    // checks of an empty ring between looks at the producer
+static const uint64_t CONSUMER_CHECK = 2000;    // checks of a full ring between looks at the consumer
+
+struct shm_ring {
+    char name[256];
+    struct shm_ring_header* header;
+    struct shm_record* records;
+    size_t bytes;       // size of the mapping
+    uint64_t mask;      // capacity - 1
+    uint64_t waits;     // checks of the current wait
+    struct timespec created;    // when the producer created the ring
+};
+
+static void ring_wait(struct shm_ring *ring) {
+    if (++ring->waits > SPINS) {
+        struct timespec ts = {0, SLEEP_NS};
+        nanosleep(&ts, NULL);
+    }
+}
+
+static struct shm_ring* ring_map(const char *name, int fd, size_t bytes) {
+    void *base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Could not map the ring %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    struct shm_ring *ring = (struct shm_ring*) calloc(1, sizeof(struct shm_ring));
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    ring->header = (struct shm_ring_header*) base;
+    ring->records = (struct shm_record*) ((char*) base + sizeof(struct shm_ring_header));
+    ring->bytes = bytes;
+    return ring;
+}
+
+/**
+ * Function to create the ring of a producer, replacing any ring of the same name
+ *
+ * @param name Name of the shared memory object, like "/cachesim"
+ * @param capacity Records the ring holds, rounded up to a power of 2
+ */
+struct shm_ring* shm_ring_create(const char *name, uint64_t capacity)
+{
+    uint64_t records = 1;
+    while (records < capacity) {
+        records <<= 1;
+    }
+    size_t bytes = sizeof(struct shm_ring_header) + records * sizeof(struct shm_record);
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)bytes) != 0) {
+        fprintf(stderr, "Could not create the ring %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    struct shm_ring *ring = ring_map(name, fd, bytes);
+    ring->mask = records - 1;
+    ring->header->capacity = records;
+    ring->header->head.store(0, std::memory_order_relaxed);
+    ring->header->tail.store(0, std::memory_order_relaxed);
+    ring->header->closed.store(0, std::memory_order_relaxed);
+    ring->header->producer = (int32_t)getpid();
+    ring->header->consumer.store(0, std::memory_order_relaxed);
+    clock_gettime(CLOCK_MONOTONIC, &ring->created);
+    ring->header->version = RING_VERSION;
+    //the magic goes last, a consumer attaching early waits for it
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(ring->header->magic, "CSRG", 4);
+    return ring;
+}
+
+/**
+ * Function to check, while the ring is full, that a consumer is there to empty it
+ * Exits, removing the ring, if none attached within the time a consumer waits
+ * for a producer or if the consumer exited
+ *
+ */
+static void check_consumer(struct shm_ring *ring) {
+    int32_t consumer = ring->header->consumer.load(std::memory_order_acquire);
+    if (consumer == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double waited = (double)(now.tv_sec - ring->created.tv_sec) + (double)(now.tv_nsec - ring->created.tv_nsec) / 1e9;
+        if (waited < (double)ATTACH_TRIES * (double)ATTACH_SLEEP_NS / 1e9) {
+            return;
+        }
+        fprintf(stderr, "No consumer attached to the ring %s\n", ring->name);
+    } else if (kill(consumer, 0) != 0 && errno == ESRCH) {
+        fprintf(stderr, "The consumer of the ring %s exited\n", ring->name);
+    } else {
+        return;
+    }
+    shm_unlink(ring->name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Function to add records to the ring, waiting while it is full
+ * Exits, removing the ring, if there is no consumer to empty it
+ *
+ */
+void shm_ring_write(struct shm_ring *ring, const struct shm_record *records, uint64_t n)
+{
+    uint64_t head = ring->header->head.load(std::memory_order_relaxed);
+    uint64_t capacity = ring->mask + 1;
+    while (n > 0) {
+        uint64_t used = head - ring->header->tail.load(std::memory_order_acquire);
+        if (used == capacity) {
+            ring_wait(ring);
+            if (ring->waits % CONSUMER_CHECK == 0) {
+                check_consumer(ring);
+            }
+            continue;
+        }
+        ring->waits = 0;
+        uint64_t count = capacity - used < n ? capacity - used : n;
+        for (uint64_t i = 0; i < count; i++) {
+            ring->records[(head + i) & ring->mask] = records[i];
+        }
+        head += count;
+        records += count;
+        n -= count;
+        ring->header->head.store(head, std::memory_order_release);
+    }
+}
+
+/**
+ * Function to mark the end of the producer's records and unmap the ring
+ * The consumer removes the ring once it has read every record
+ *
+ */
+void shm_ring_close(struct shm_ring *ring)
+{
+    ring->header->closed.store(1, std::memory_order_release);
+    munmap(ring->header, ring->bytes);
+    free(ring);
+}
+
+/**
+ * Function to attach to the ring a producer created, waiting a while for it to appear
+ *
+ */
+struct shm_ring* shm_ring_attach(const char *name)
+{
+    struct timespec ts = {0, ATTACH_SLEEP_NS};
+    for (uint64_t i = 0; i < ATTACH_TRIES; i++) {
+        int fd = shm_open(name, O_RDWR, 0600);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(struct shm_ring_header)) {
+            struct shm_ring *ring = ring_map(name, fd, (size_t)st.st_size);
+            if (memcmp(ring->header->magic, "CSRG", 4) == 0) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (ring->header->version != RING_VERSION ||
+                    sizeof(struct shm_ring_header) + ring->header->capacity * sizeof(struct shm_record) != ring->bytes) {
+                    fprintf(stderr, "The ring %s is not of this simulator version\n", name);
+                    exit(EXIT_FAILURE);
+                }
+                ring->mask = ring->header->capacity - 1;
+                ring->header->consumer.store((int32_t)getpid(), std::memory_order_release);
+                return ring;
+            }
+            munmap(ring->header, ring->bytes);
+            free(ring);
+        } else if (fd >= 0) {
+            close(fd);
+        }
+        nanosleep(&ts, NULL);
+    }
+    fprintf(stderr, "No producer created the ring %s\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Function to take the next batch of records out of the ring, waiting while it is empty
+ * Returns the records taken, 0 once the producer closed the ring and it is empty
+ * Exits, removing the ring, if the producer exited without closing it
+ *
+ */
+uint64_t shm_ring_read(struct shm_ring *ring, struct shm_record *records, uint64_t max)
+{
+    uint64_t tail = ring->header->tail.load(std::memory_order_relaxed);
+    bool gone = false;
+    while (true) {
+        //read closed first, records written before it was set are then visible in head
+        bool closed = ring->header->closed.load(std::memory_order_acquire);
+        uint64_t head = ring->header->head.load(std::memory_order_acquire);
+        if (head != tail) {
+            ring->waits = 0;
+            uint64_t count = head - tail < max ? head - tail : max;
+            for (uint64_t i = 0; i < count; i++) {
+                records[i] = ring->records[(tail + i) & ring->mask];
+            }
+            ring->header->tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+        if (closed) {
+            return 0;
+        }
+        //the producer was already gone before this last look at head
+        if (gone) {
+            fprintf(stderr, "The producer of the ring %s exited without closing it\n", ring->name);
+            shm_unlink(ring->name);
+            exit(EXIT_FAILURE);
+        }
+        ring_wait(ring);
+        if (ring->waits % PRODUCER_CHECK == 0) {
+            gone = kill(ring->header->producer, 0) != 0 && errno == ESRCH;
+        }
+    }
+}
+
+void shm_ring_detach(struct shm_ring *ring)
+{
+    munmap(ring->header, ring->bytes);
+    shm_unlink(ring->name);
+    free(ring);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file shm_ring.hpp
+ * @brief Shared memory ring of accesses from a live trace producer
+ *
+ * A producer creates a POSIX shared memory object holding a single-producer,
+ * single-consumer ring of fixed-size access records, and the simulator
+ * attaches to it and consumes the records in batches. A full ring makes the
+ * producer wait for the simulator, an empty one makes the simulator wait for
+ * the producer, until the producer closes the ring. The simulator gives up on
+ * a ring whose producer exited without closing it, and the producer gives up
+ * on a full ring no simulator attached to in time or whose simulator exited.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <cinttypes>
+
+// One access of the ring
+struct shm_record {
+    uint64_t addr;
+    uint32_t size;      // bytes, 0 if not known
+    uint8_t type;       // 'I', 'L' or 'S'
+    uint8_t core;
+    uint16_t unused;
+};
+
+// Start of the shared memory object, the records follow it
+struct shm_ring_header {
+    char magic[4];                  // "CSRG"
+    uint32_t version;
+    uint64_t capacity;              // records, a power of 2
+    int32_t producer;               // pid of the producer
+    std::atomic<int32_t> consumer;  // pid of the consumer, 0 until one attaches
+    alignas(64) std::atomic<uint64_t> head;     // records written, only the producer moves it
+    alignas(64) std::atomic<uint64_t> tail;     // records read, only the consumer moves it
+    alignas(64) std::atomic<uint32_t> closed;   // the producer wrote its last record
+};
+
+struct shm_ring;
+
+struct shm_ring* shm_ring_create(const char *name, uint64_t capacity);
+void shm_ring_write(struct shm_ring *ring, const struct shm_record *records, uint64_t n);
+void shm_ring_close(struct shm_ring *ring);
+
+struct shm_ring* shm_ring_attach(const char *name);
+uint64_t shm_ring_read(struct shm_ring *ring, struct shm_record *records, uint64_t max);
+void shm_ring_detach(struct shm_ring *ring);
+
+#endif // SHM_RING_H
@@ -0,0 +1,200 @@
+/**
+ * @file timeseries.cpp
+ * @brief Windowed statistics for the cache simulator
+ *
+ * Closing a window only copies the running counters of every cache into the
+ * next snapshot of a batch. The differences between snapshots are taken and
+ * written once a batch is full and when the run ends, so an access pays for a
+ * counter update and one compare.
+ *
+ * CSV output has one row per window and cache:
+ *     window,end,aat,cache,accesses,misses,miss_rate,write_backs,bytes_transferred
+ * where end is the access count or cycle that closed the window and aat the
+ * average latency of the window's accesses. Binary output starts with the
+ * magic "CSTS", a uint32 version, uint64 caches and char name[64] per cache,
+ * then per window: uint64 end, uint64 accesses, double aat and uint64
+ * {accesses, misses, write_backs, bytes_transferred} per cache, little endian.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "timeseries.hpp"
+
+static const uint64_t WINDOW_BATCH = 64;
+static const uint32_t BINARY_VERSION = 1;
+
+typedef struct window_counts {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t write_backs;
+    uint64_t bytes;
+} window_counts;
+
+typedef struct snapshot {
+    uint64_t end;       // access count or cycle that closed the window
+    uint64_t accesses;  // accesses of the cores so far
+    double latency;     // latency of those accesses so far
+    window_counts* caches;
+} snapshot;
+
+struct timeseries {
+    FILE* out;
+    struct timeseries_config_t conf;
+    uint64_t num_caches;
+    uint64_t accesses;
+    double latency;
+    uint64_t next;      // end of the current window
+    uint64_t window;    // windows written so far
+    snapshot batch[WINDOW_BATCH];
+    uint64_t used;
+    snapshot prev;      // last snapshot written
+};
+
+static void snapshot_take(struct timeseries *ts, snapshot *s, uint64_t end, const struct sim_stats_t *sim_stats) {
+    s->end = end;
+    s->accesses = ts->accesses;
+    s->latency = ts->latency;
+    for (uint64_t i = 0; i < ts->num_caches; i++) {
+        const struct cache_stats_t *stats = &sim_stats->caches[i];
+        s->caches[i].accesses = stats->num_accesses;
+        s->caches[i].misses = stats->num_misses;
+        s->caches[i].write_backs = stats->num_write_backs;
+        s->caches[i].bytes = stats->num_bytes_transferred;
+    }
+}
+
+/**
+ * Function to write the windows of a full batch as differences to the snapshot
+ * before, after the header if nothing was written yet
+ *
+ */
+static void timeseries_flush(struct timeseries *ts, const struct sim_stats_t *sim_stats) {
+    if (ts->window == 0 && ts->conf.format == OUTPUT_BINARY) {
+        fwrite("CSTS", 1, 4, ts->out);
+        fwrite(&BINARY_VERSION, sizeof(BINARY_VERSION), 1, ts->out);
+        fwrite(&ts->num_caches, sizeof(uint64_t), 1, ts->out);
+        for (uint64_t i = 0; i < ts->num_caches; i++) {
+            fwrite(sim_stats->caches[i].name, 1, 64, ts->out);
+        }
+    } else if (ts->window == 0) {
+        fprintf(ts->out, "window,end,aat,cache,accesses,misses,miss_rate,write_backs,bytes_transferred\n");
+    }
+    for (uint64_t w = 0; w < ts->used; w++) {
+        snapshot *s = &ts->batch[w];
+        uint64_t accesses = s->accesses - ts->prev.accesses;
+        double aat = accesses ? (s->latency - ts->prev.latency) / (double)accesses : 0;
+        if (ts->conf.format == OUTPUT_BINARY) {
+            fwrite(&s->end, sizeof(uint64_t), 1, ts->out);
+            fwrite(&accesses, sizeof(uint64_t), 1, ts->out);
+            fwrite(&aat, sizeof(double), 1, ts->out);
+        }
+        for (uint64_t i = 0; i < ts->num_caches; i++) {
+            window_counts d;
+            d.accesses = s->caches[i].accesses - ts->prev.caches[i].accesses;
+            d.misses = s->caches[i].misses - ts->prev.caches[i].misses;
+            d.write_backs = s->caches[i].write_backs - ts->prev.caches[i].write_backs;
+            d.bytes = s->caches[i].bytes - ts->prev.caches[i].bytes;
+            if (ts->conf.format == OUTPUT_BINARY) {
+                fwrite(&d, sizeof(window_counts), 1, ts->out);
+            } else {
+                fprintf(ts->out, "%" PRIu64 ",%" PRIu64 ",%.8f,%s,%" PRIu64 ",%" PRIu64 ",%.8f,%" PRIu64 ",%" PRIu64 "\n",
+                        ts->window, s->end, aat, sim_stats->caches[i].name, d.accesses, d.misses,
+                        d.accesses ? (double)d.misses / (double)d.accesses : 0, d.write_backs, d.bytes);
+            }
+        }
+        ts->window++;
+        //the snapshot becomes the start of the next window
+        window_counts *caches = ts->prev.caches;
+        ts->prev = *s;
+        s->caches = caches;
+    }
+    ts->used = 0;
+}
+
+struct timeseries* timeseries_create(const struct timeseries_config_t *conf, uint64_t num_caches)
+{
+    struct timeseries *ts = (struct timeseries*) calloc(1, sizeof(struct timeseries));
+    ts->out = fopen(conf->file, conf->format == OUTPUT_BINARY ? "wb" : "w");
+    if (ts->out == NULL) {
+        fprintf(stderr, "Could not open the time series file %s\n", conf->file);
+        exit(EXIT_FAILURE);
+    }
+    ts->conf = *conf;
+    ts->num_caches = num_caches;
+    ts->next = conf->interval;
+    for (uint64_t w = 0; w < WINDOW_BATCH; w++) {
+        ts->batch[w].caches = (window_counts*) malloc(ts->num_caches * sizeof(window_counts));
+    }
+    ts->prev.caches = (window_counts*) calloc(ts->num_caches, sizeof(window_counts));
+    return ts;
+}
+
+/**
+ * Function to count one access of a core and close the window it ends
+ *
+ * @param ts The time series
+ * @param now Cycle of the core after the access, for windows of cycles
+ * @param latency Latency of the access
+ * @param sim_stats Statistics the windows are taken from
+ */
+void timeseries_access(struct timeseries *ts, uint64_t now, double latency, const struct sim_stats_t *sim_stats)
+{
+    ts->accesses++;
+    ts->latency += latency;
+    uint64_t end = ts->conf.cycles ? now : ts->accesses;
+    if (end < ts->next) {
+        return;
+    }
+    snapshot_take(ts, &ts->batch[ts->used++], end, sim_stats);
+    //a long stall may skip windows, the next one ends on the next multiple
+    ts->next = (end / ts->conf.interval + 1) * ts->conf.interval;
+    if (ts->used == WINDOW_BATCH) {
+        timeseries_flush(ts, sim_stats);
+    }
+}
+
+/**
+ * Function to write the last, partial window and close the time series
+ *
+ * @param ts The time series
+ * @param now Latest cycle of the cores, for windows of cycles
+ * @param sim_stats Statistics at the end of the run
+ */
+void timeseries_close(struct timeseries *ts, uint64_t now, const struct sim_stats_t *sim_stats)
+{
+    if (ts == NULL) {
+        return;
+    }
+    const snapshot *last = ts->used ? &ts->batch[ts->used - 1] : &ts->prev;
+    snapshot *s = &ts->batch[ts->used++];
+    snapshot_take(ts, s, ts->conf.cycles ? now : ts->accesses, sim_stats);
+    //nothing happened since the last window closed
+    if (ts->window + ts->used > 1 && s->accesses == last->accesses &&
+        memcmp(s->caches, last->caches, ts->num_caches * sizeof(window_counts)) == 0) {
+        ts->used--;
+    }
+    timeseries_flush(ts, sim_stats);
+    timeseries_discard(ts);
+}
+
+/**
+ * Function to close the time series without writing the windows still held
+ *
+ */
+void timeseries_discard(struct timeseries *ts)
+{
+    if (ts == NULL) {
+        return;
+    }
+    fclose(ts->out);
+    for (uint64_t w = 0; w < WINDOW_BATCH; w++) {
+        free(ts->batch[w].caches);
+    }
+    free(ts->prev.caches);
+    free(ts);
+}
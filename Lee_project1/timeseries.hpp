@@ -0,0 +1,26 @@
+/**
+ * @file timeseries.hpp
+ * @brief Windowed statistics for the cache simulator
+ *
+ * The run is cut into windows of a fixed number of accesses or core cycles.
+ * For every window the time series writes the overall average access time
+ * and each cache's accesses, misses, write backs and bytes transferred.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+struct timeseries;
+
+struct timeseries* timeseries_create(const struct timeseries_config_t *conf, uint64_t num_caches);
+void timeseries_access(struct timeseries *ts, uint64_t now, double latency, const struct sim_stats_t *sim_stats);
+void timeseries_close(struct timeseries *ts, uint64_t now, const struct sim_stats_t *sim_stats);
+void timeseries_discard(struct timeseries *ts);
+
+#endif // TIMESERIES_H
@@ -0,0 +1,170 @@
+/**
+ * @file tlb.cpp
+ * @brief TLBs and a synthetic page table for the cache simulator
+ *
+ * A TLB is a set associative array of virtual page numbers with LRU
+ * replacement. The page table is an x86-64 style radix tree over a 48 bit
+ * virtual address space, 9 bits of page number per level: four levels for
+ * 4KiB pages, three for 2MiB and two for 1GiB. Physical frames and table
+ * nodes are handed out on first touch, in the order the program touches them,
+ * so a run only depends on its trace. Table nodes are 4KiB pages in their own
+ * physical region above the data frames.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+
+#include "tlb.hpp"
+#include "u64_map.hpp"
+
+static const uint64_t VA_BITS = 48;
+static const uint64_t LEVEL_BITS = 9;
+static const uint64_t PTE_SIZE = 8;
+static const uint64_t TABLE_PAGE_BITS = 12;
+static const uint64_t TABLE_REGION = (uint64_t)1 << 52;
+static const uint64_t MAP_INITIAL_ENTRIES = 1024;
+
+typedef struct tlb_entry {
+    bool valid;
+    uint64_t vpn;
+    uint64_t history;   // for LRU replacement
+} tlb_entry;
+
+struct tlb {
+    tlb_entry* entries;
+    uint64_t sets;
+    uint64_t ways;
+    uint64_t count;
+};
+
+struct page_table {
+    uint64_t page_bits;
+    uint64_t levels;        // PTEs read by a walk
+    struct u64_map* map;    // data frames by page number, table nodes by level and prefix
+    uint64_t data_frames;   // frames handed out so far
+    uint64_t table_frames;
+};
+
+struct tlb* tlb_create(const struct tlb_config_t *conf)
+{
+    if (conf->entries == 0) {
+        return NULL;
+    }
+    struct tlb *t = (struct tlb*) malloc(sizeof(struct tlb));
+    t->ways = (uint64_t)1 << conf->s;
+    t->sets = conf->entries >> conf->s;
+    t->count = 1;
+    t->entries = (tlb_entry*) calloc(conf->entries, sizeof(tlb_entry));
+    return t;
+}
+
+/**
+ * Function to look up a translation, a hit makes it the most recently used
+ * Returns true on a hit
+ *
+ */
+bool tlb_lookup(struct tlb *t, uint64_t vpn)
+{
+    tlb_entry *set = &t->entries[(vpn & (t->sets - 1)) * t->ways];
+    for (uint64_t i = 0; i < t->ways; i++) {
+        if (set[i].valid && set[i].vpn == vpn) {
+            set[i].history = t->count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function to insert a translation in place of the least recently used one
+ *
+ */
+void tlb_insert(struct tlb *t, uint64_t vpn)
+{
+    tlb_entry *set = &t->entries[(vpn & (t->sets - 1)) * t->ways];
+    tlb_entry *victim = &set[0];
+    for (uint64_t i = 0; i < t->ways; i++) {
+        if (!set[i].valid) {
+            victim = &set[i];
+            break;
+        }
+        if (set[i].history < victim->history) {
+            victim = &set[i];
+        }
+    }
+    victim->valid = true;
+    victim->vpn = vpn;
+    victim->history = t->count++;
+}
+
+void tlb_destroy(struct tlb *t)
+{
+    if (t == NULL) {
+        return;
+    }
+    free(t->entries);
+    free(t);
+}
+
+/**
+ * Function to look up the frame of a page or a table node, handing out the
+ * next free one on first touch
+ *
+ */
+static uint64_t map_frame(struct page_table *pt, uint64_t key, uint64_t *next) {
+    bool added;
+    uint64_t *frame = (uint64_t*) u64_map_add(pt->map, key, &added);
+    if (added) {
+        *frame = (*next)++;
+    }
+    return *frame;
+}
+
+struct page_table* page_table_create(uint64_t page_bits)
+{
+    struct page_table *pt = (struct page_table*) malloc(sizeof(struct page_table));
+    pt->page_bits = page_bits;
+    pt->levels = (VA_BITS - page_bits + LEVEL_BITS - 1) / LEVEL_BITS;
+    pt->data_frames = 0;
+    pt->table_frames = 0;
+    pt->map = u64_map_create(MAP_INITIAL_ENTRIES, sizeof(uint64_t));
+    return pt;
+}
+
+/**
+ * Function to translate a virtual page number
+ * Returns the physical frame number
+ *
+ */
+uint64_t page_table_frame(struct page_table *pt, uint64_t vpn)
+{
+    //data pages are keyed one level below the leaf table nodes
+    return map_frame(pt, (pt->levels << 56) | vpn, &pt->data_frames);
+}
+
+/**
+ * Function to find the PTEs a walk for a virtual page number reads, root first
+ * Returns the number of PTEs
+ *
+ */
+uint64_t page_table_walk(struct page_table *pt, uint64_t vpn, uint64_t *ptes)
+{
+    for (uint64_t l = 0; l < pt->levels; l++) {
+        uint64_t shift = LEVEL_BITS * (pt->levels - 1 - l);
+        uint64_t node = map_frame(pt, (l << 56) | (vpn >> (shift + LEVEL_BITS)), &pt->table_frames);
+        uint64_t index = (vpn >> shift) & (((uint64_t)1 << LEVEL_BITS) - 1);
+        ptes[l] = TABLE_REGION + (node << TABLE_PAGE_BITS) + index * PTE_SIZE;
+    }
+    return pt->levels;
+}
+
+void page_table_destroy(struct page_table *pt)
+{
+    if (pt == NULL) {
+        return;
+    }
+    u64_map_destroy(pt->map);
+    free(pt);
+}
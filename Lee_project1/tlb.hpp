@@ -0,0 +1,35 @@
+/**
+ * @file tlb.hpp
+ * @brief TLBs and a synthetic page table for the cache simulator
+ *
+ * The TLBs only remember which virtual pages they can translate. The page
+ * table hands out physical frames and the addresses of the PTEs a walk reads;
+ * the cache hierarchy performs the PTE loads itself.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef TLB_H
+#define TLB_H
+
+#include <cinttypes>
+
+#include "cache.hpp"
+
+// Deepest page walk, a 4KiB page of a 48 bit virtual address space
+static const uint64_t MAX_WALK_LEVELS = 4;
+
+struct tlb;
+struct page_table;
+
+struct tlb* tlb_create(const struct tlb_config_t *conf);
+bool tlb_lookup(struct tlb *t, uint64_t vpn);
+void tlb_insert(struct tlb *t, uint64_t vpn);
+void tlb_destroy(struct tlb *t);
+
+struct page_table* page_table_create(uint64_t page_bits);
+uint64_t page_table_frame(struct page_table *pt, uint64_t vpn);
+uint64_t page_table_walk(struct page_table *pt, uint64_t vpn, uint64_t *ptes);
+void page_table_destroy(struct page_table *pt);
+
+#endif // TLB_H
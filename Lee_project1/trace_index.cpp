@@ -0,0 +1,163 @@
+/**
+ * @file trace_index.cpp
+ * @brief Sidecar index of access offsets in a trace for the cache simulator
+ *
+ * The index of <trace> is <trace>.idx. It starts with the magic "CSTI", a
+ * uint32 version and a uint32 stride, then uint64 {trace bytes, trace
+ * modification time, accesses, entries} and the uint64 byte offset of
+ * accesses 0, stride, 2 * stride and so on, little endian. An index whose
+ * trace bytes or modification time differ from the trace is stale.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+#include "trace_index.hpp"
+
+static const uint32_t INDEX_STRIDE = 1024;
+static const uint32_t BINARY_VERSION = 1;
+
+struct trace_index {
+    char file[512];     // index file, the trace name with ".idx"
+    uint64_t bytes;     // size of the trace when indexed
+    uint64_t mtime;     // modification time of the trace when indexed
+    uint64_t accesses;
+    uint64_t* offsets;  // offset of every stride-th access
+    uint64_t size;      // entries allocated
+};
+
+static struct trace_index* index_alloc(const char *trace) {
+    struct stat st;
+    if (stat(trace, &st) != 0) {
+        return NULL;
+    }
+    struct trace_index *idx = (struct trace_index*) calloc(1, sizeof(struct trace_index));
+    snprintf(idx->file, sizeof(idx->file), "%s.idx", trace);
+    idx->bytes = (uint64_t)st.st_size;
+    idx->mtime = (uint64_t)st.st_mtime;
+    return idx;
+}
+
+/**
+ * Function to read the saved index of a trace
+ * Returns NULL if there is none or it is stale
+ *
+ */
+struct trace_index* trace_index_load(const char *trace)
+{
+    struct trace_index *idx = index_alloc(trace);
+    if (idx == NULL) {
+        return NULL;
+    }
+    FILE *in = fopen(idx->file, "rb");
+    char magic[4];
+    uint32_t header[2];
+    uint64_t fields[4];
+    if (in == NULL || fread(magic, 1, 4, in) != 4 || fread(header, sizeof(uint32_t), 2, in) != 2 ||
+        fread(fields, sizeof(uint64_t), 4, in) != 4 || memcmp(magic, "CSTI", 4) != 0 ||
+        header[0] != BINARY_VERSION || header[1] != INDEX_STRIDE || fields[0] != idx->bytes || fields[1] != idx->mtime) {
+        if (in != NULL) {
+            fclose(in);
+        }
+        free(idx);
+        return NULL;
+    }
+    idx->accesses = fields[2];
+    idx->size = fields[3];
+    idx->offsets = (uint64_t*) malloc((idx->size ? idx->size : 1) * sizeof(uint64_t));
+    bool complete = fread(idx->offsets, sizeof(uint64_t), idx->size, in) == idx->size;
+    fclose(in);
+    if (!complete || idx->size != (idx->accesses + INDEX_STRIDE - 1) / INDEX_STRIDE) {
+        trace_index_destroy(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+/**
+ * Function to start an empty index of a trace, filled by trace_index_add
+ *
+ */
+struct trace_index* trace_index_create(const char *trace)
+{
+    struct trace_index *idx = index_alloc(trace);
+    if (idx == NULL) {
+        fprintf(stderr, "Could not index the trace %s\n", trace);
+        exit(EXIT_FAILURE);
+    }
+    idx->size = 1024;
+    idx->offsets = (uint64_t*) malloc(idx->size * sizeof(uint64_t));
+    return idx;
+}
+
+/**
+ * Function to count the next access of the trace, read from offset
+ *
+ */
+void trace_index_add(struct trace_index *idx, uint64_t offset)
+{
+    if (idx->accesses % INDEX_STRIDE == 0) {
+        uint64_t entry = idx->accesses / INDEX_STRIDE;
+        if (entry == idx->size) {
+            idx->size *= 2;
+            idx->offsets = (uint64_t*) realloc(idx->offsets, idx->size * sizeof(uint64_t));
+        }
+        idx->offsets[entry] = offset;
+    }
+    idx->accesses++;
+}
+
+/**
+ * Function to write the index next to its trace, a run goes on without it if that fails
+ *
+ */
+void trace_index_save(const struct trace_index *idx)
+{
+    FILE *out = fopen(idx->file, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Could not save the trace index %s\n", idx->file);
+        return;
+    }
+    uint32_t header[2] = {BINARY_VERSION, INDEX_STRIDE};
+    uint64_t entries = (idx->accesses + INDEX_STRIDE - 1) / INDEX_STRIDE;
+    uint64_t fields[4] = {idx->bytes, idx->mtime, idx->accesses, entries};
+    fwrite("CSTI", 1, 4, out);
+    fwrite(header, sizeof(uint32_t), 2, out);
+    fwrite(fields, sizeof(uint64_t), 4, out);
+    fwrite(idx->offsets, sizeof(uint64_t), entries, out);
+    fclose(out);
+}
+
+uint64_t trace_index_accesses(const struct trace_index *idx)
+{
+    return idx->accesses;
+}
+
+/**
+ * Function to move a trace to the indexed access at or before an access
+ * Returns the accesses left to read before the access, less than the stride
+ *
+ */
+uint64_t trace_index_seek(const struct trace_index *idx, FILE *trace, uint64_t access)
+{
+    if (access >= idx->accesses) {
+        fseek(trace, 0, SEEK_END);
+        return 0;
+    }
+    fseek(trace, (long)idx->offsets[access / INDEX_STRIDE], SEEK_SET);
+    return access % INDEX_STRIDE;
+}
+
+void trace_index_destroy(struct trace_index *idx)
+{
+    if (idx == NULL) {
+        return;
+    }
+    free(idx->offsets);
+    free(idx);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file trace_index.hpp
+ * @brief Sidecar index of access offsets in a trace for the cache simulator
+ *
+ * The index holds the byte offset of every INDEX_STRIDE-th access of a text
+ * trace, so a run can start at any access after reading at most a stride of
+ * lines. It is saved next to the trace and rebuilt once the trace changes.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef TRACE_INDEX_H
+#define TRACE_INDEX_H
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "cache.hpp"
+
+struct trace_index;
+
+struct trace_index* trace_index_load(const char *trace);
+struct trace_index* trace_index_create(const char *trace);
+void trace_index_add(struct trace_index *idx, uint64_t offset);
+void trace_index_save(const struct trace_index *idx);
+uint64_t trace_index_accesses(const struct trace_index *idx);
+uint64_t trace_index_seek(const struct trace_index *idx, FILE *trace, uint64_t access);
+void trace_index_destroy(struct trace_index *idx);
+
+#endif // TRACE_INDEX_H
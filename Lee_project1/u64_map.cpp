@@ -0,0 +1,168 @@
+/**
+ * @file u64_map.cpp
+ * @brief Hash map from uint64 keys to fixed size values for the cache simulator
+ *
+ * Open addressing with linear probing. A slot holds the key plus one, so 0 is
+ * empty, followed by the value. The table doubles once it is half full, and a
+ * removal moves later slots of its probe run back so lookups never stop early.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+
+#include "u64_map.hpp"
+
+struct u64_map {
+    uint8_t* slots;
+    size_t stride;      // bytes of a slot, a multiple of 8
+    uint64_t size;      // power of 2
+    uint64_t used;
+};
+
+static uint64_t u64_hash(uint64_t key, uint64_t size) {
+    key ^= key >> 29;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 32;
+    return key & (size - 1);
+}
+
+static uint64_t* slot_key(const struct u64_map *m, uint64_t i) {
+    return (uint64_t*) (m->slots + i * m->stride);
+}
+
+// Slot of a key, or the empty slot it would go in
+static uint64_t slot_of(const struct u64_map *m, uint64_t key) {
+    uint64_t i = u64_hash(key, m->size);
+    while (*slot_key(m, i) != 0 && *slot_key(m, i) != key + 1) {
+        i = (i + 1) & (m->size - 1);
+    }
+    return i;
+}
+
+static void u64_map_grow(struct u64_map *m) {
+    uint8_t *old = m->slots;
+    uint64_t old_size = m->size;
+    m->size *= 2;
+    m->slots = (uint8_t*) calloc(m->size, m->stride);
+    for (uint64_t i = 0; i < old_size; i++) {
+        uint64_t key = *(uint64_t*) (old + i * m->stride);
+        if (key != 0) {
+            memcpy(slot_key(m, slot_of(m, key - 1)), old + i * m->stride, m->stride);
+        }
+    }
+    free(old);
+}
+
+/**
+ * Function to allocate an empty map
+ *
+ * @param entries Slots to start with, rounded up to a power of 2
+ * @param value_size Bytes of a value, 0 for a set of keys
+ */
+struct u64_map* u64_map_create(uint64_t entries, size_t value_size)
+{
+    struct u64_map *m = (struct u64_map*) malloc(sizeof(struct u64_map));
+    m->stride = sizeof(uint64_t) + (value_size + 7) / 8 * 8;
+    m->size = 1;
+    while (m->size < entries) {
+        m->size *= 2;
+    }
+    m->used = 0;
+    m->slots = (uint8_t*) calloc(m->size, m->stride);
+    return m;
+}
+
+/**
+ * Function to look up a key
+ * Returns its value, NULL if the key is not in the map
+ *
+ */
+void* u64_map_find(const struct u64_map *m, uint64_t key)
+{
+    uint64_t *slot = slot_key(m, slot_of(m, key));
+    return *slot != 0 ? slot + 1 : NULL;
+}
+
+/**
+ * Function to look up a key, adding it with a zeroed value if it is not there
+ * Returns its value
+ *
+ * @param added Set to true if the key was added, may be NULL
+ */
+void* u64_map_add(struct u64_map *m, uint64_t key, bool *added)
+{
+    uint64_t *slot = slot_key(m, slot_of(m, key));
+    if (added != NULL) {
+        *added = *slot == 0;
+    }
+    if (*slot != 0) {
+        return slot + 1;
+    }
+    if (2 * (m->used + 1) > m->size) {
+        u64_map_grow(m);
+        slot = slot_key(m, slot_of(m, key));
+    }
+    *slot = key + 1;
+    m->used++;
+    return slot + 1;
+}
+
+void u64_map_remove(struct u64_map *m, uint64_t key)
+{
+    uint64_t hole = slot_of(m, key);
+    if (*slot_key(m, hole) == 0) {
+        return;
+    }
+    uint64_t mask = m->size - 1;
+    uint64_t i = hole;
+    m->used--;
+    while (true) {
+        i = (i + 1) & mask;
+        uint64_t next = *slot_key(m, i);
+        if (next == 0) {
+            break;
+        }
+        uint64_t home = u64_hash(next - 1, m->size);
+        //move the slot back if the hole lies between its home slot and its slot
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            memcpy(slot_key(m, hole), slot_key(m, i), m->stride);
+            hole = i;
+        }
+    }
+    memset(slot_key(m, hole), 0, m->stride);
+}
+
+/**
+ * Function to walk the map in slot order, starting with *pos = 0
+ * Returns the value of the next key, NULL once every key was seen
+ *
+ */
+void* u64_map_next(const struct u64_map *m, uint64_t *pos, uint64_t *key)
+{
+    for (; *pos < m->size; (*pos)++) {
+        uint64_t *slot = slot_key(m, *pos);
+        if (*slot != 0) {
+            (*pos)++;
+            *key = *slot - 1;
+            return slot + 1;
+        }
+    }
+    return NULL;
+}
+
+uint64_t u64_map_size(const struct u64_map *m)
+{
+    return m->used;
+}
+
+void u64_map_destroy(struct u64_map *m)
+{
+    if (m == NULL) {
+        return;
+    }
+    free(m->slots);
+    free(m);
+}
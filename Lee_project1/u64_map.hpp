@@ -0,0 +1,28 @@
+/**
+ * @file u64_map.hpp
+ * @brief Hash map from uint64 keys to fixed size values for the cache simulator
+ *
+ * Tables keyed by block or page number use this map rather than each keeping
+ * a hash table of its own. A value is a plain struct the map zeroes when its
+ * key is added. Pointers to values stay valid until the next add or remove.
+ *
+ * @author <Won Jun Lee>
+ */
+
+#ifndef U64_MAP_H
+#define U64_MAP_H
+
+#include <cinttypes>
+#include <cstddef>
+
+struct u64_map;
+
+struct u64_map* u64_map_create(uint64_t entries, size_t value_size);
+void* u64_map_find(const struct u64_map *m, uint64_t key);
+void* u64_map_add(struct u64_map *m, uint64_t key, bool *added);
+void u64_map_remove(struct u64_map *m, uint64_t key);
+void* u64_map_next(const struct u64_map *m, uint64_t *pos, uint64_t *key);
+uint64_t u64_map_size(const struct u64_map *m);
+void u64_map_destroy(struct u64_map *m);
+
+#endif // U64_MAP_H